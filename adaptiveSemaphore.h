@@ -0,0 +1,130 @@
+#ifndef ADAPTIVESEMAPHORE_H
+#define ADAPTIVESEMAPHORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "sharedCounters.h"
+
+
+/*************************************
+ * ADAPTIVE SEMAPHORE (SPIN THEN PARK)
+ * A thread blocked on a semaphore sleeps in the kernel. Waking it up costs a system call
+ * for the releasing thread, then the scheduler has to run the waiter again: several
+ * microseconds, much more than a short critical section or a quick handoff.
+ *
+ * AdaptiveSemaphore::acquire() first tries to take the count, then spins for a while
+ * (the releasing thread is probably running on another core and will release soon),
+ * and only then parks the thread with std::atomic::wait (a futex on Linux).
+ * - the spin length adapts: when spinning succeeds, the limit moves towards twice the
+ *   spins it took; when spinning fails, the limit is halved (spinning was wasted CPU).
+ * - on a single core machine, spinning can't succeed (the releasing thread can't run while
+ *   we spin): the limit is 0.
+ * - release() only makes the wake up system call when a thread is parked.
+ * - fastAcquires() counts acquires done without parking (at once or after spinning),
+ *   slowAcquires() those that parked.
+ * Same interface as std::counting_semaphore (acquire, try_acquire, release) without the
+ * timed waits.
+ * **********************************/
+
+
+/// Tells the CPU that we are spinning: frees resources for the other hyperthread, saves power
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+
+class AdaptiveSemaphore
+{
+public:
+    static constexpr int minSpins { 16 };
+    static constexpr int maxSpins { 4000 };
+
+    explicit AdaptiveSemaphore(std::ptrdiff_t initial = 0)
+        : m_count(initial), m_spinLimit(std::thread::hardware_concurrency() > 1 ? minSpins * 4 : 0)
+    {}
+
+    AdaptiveSemaphore(const AdaptiveSemaphore&) = delete;
+    AdaptiveSemaphore& operator=(const AdaptiveSemaphore&) = delete;
+
+    bool try_acquire()
+    {
+        auto count { m_count.load(std::memory_order_relaxed) };
+        while (count > 0)
+            if (m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+
+    void acquire()
+    {
+        if (try_acquire() || spin()) {
+            ++m_fastAcquires;
+            return;
+        }
+
+        ++m_slowAcquires;
+        // seq_cst on both sides: either release() sees the waiter, or the waiter sees the new count
+        m_waiters.fetch_add(1);
+        while (true) {
+            auto count { m_count.load() };
+            if (count > 0) {
+                if (m_count.compare_exchange_weak(count, count - 1))
+                    break;
+                continue;
+            }
+            m_count.wait(0);
+        }
+        m_waiters.fetch_sub(1);
+    }
+
+    void release(std::ptrdiff_t update = 1)
+    {
+        m_count.fetch_add(update);
+        if (m_waiters.load() == 0)
+            return;
+        if (update == 1)
+            m_count.notify_one();
+        else
+            m_count.notify_all();
+    }
+
+    long fastAcquires() const { return m_fastAcquires.value(); }
+    long slowAcquires() const { return m_slowAcquires.value(); }
+    int spinLimit() const { return m_spinLimit.load(std::memory_order_relaxed); }
+
+private:
+    /// Spins up to the current limit, and adapts the limit to the result
+    bool spin()
+    {
+        const int limit { m_spinLimit.load(std::memory_order_relaxed) };
+        if (limit == 0)   // single core
+            return false;
+        for (int spins { 0 }; spins < limit; spins++) {
+            cpuRelax();
+            if (m_count.load(std::memory_order_relaxed) > 0 && try_acquire()) {
+                // Moving average towards twice the spins needed
+                m_spinLimit.store(std::clamp(limit + (2 * spins - limit) / 4, minSpins, maxSpins), std::memory_order_relaxed);
+                return true;
+            }
+        }
+        m_spinLimit.store(std::max(limit / 2, minSpins), std::memory_order_relaxed);
+        return false;
+    }
+
+    std::atomic<std::ptrdiff_t> m_count;
+    std::atomic<int> m_waiters { 0 };
+    std::atomic<int> m_spinLimit;   // shared by all acquiring threads, updated without synchronization
+    AtomicCounter m_fastAcquires;
+    AtomicCounter m_slowAcquires;
+};
+
+
+#endif // ADAPTIVESEMAPHORE_H
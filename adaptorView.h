@@ -0,0 +1,105 @@
+#ifndef ADAPTORVIEW_H
+#define ADAPTORVIEW_H
+
+#include <cstddef>
+#include <queue>
+#include <stack>
+
+
+/*************************************
+ * CONTAINER ADAPTORS
+ * queue, stack and priority_queue are not containers: they are adaptors that wrap a real
+ * container (deque or vector by default) and only expose a restricted interface.
+ * There is no way to iterate over them, so printing usually means copying the adaptor
+ * and popping every item.
+ *
+ * The wrapped container is a protected member named 'c' (required by the standard).
+ * A class deriving from the adaptor can build a pointer to that member and apply it
+ * to any adaptor object. This gives a read only access to the items, without copy.
+ *
+ * AdaptorView exposes begin/end/size over the wrapped container:
+ * - queue: from front to back (pop order)
+ * - stack: from top to bottom (pop order)
+ * - priority_queue: heap order (top first, others are not sorted). Sorting would need a copy.
+ * **********************************/
+
+
+/// Returns a const reference to the container wrapped by an adaptor
+template<typename Adaptor>
+const typename Adaptor::container_type& underlyingContainer(const Adaptor& adaptor)
+{
+    struct Access : Adaptor {
+        static const typename Adaptor::container_type& get(const Adaptor& a)
+        {
+            return a.*(&Access::c);
+        }
+    };
+    return Access::get(adaptor);
+}
+
+
+template<typename Iterator>
+class AdaptorView
+{
+public:
+    AdaptorView(Iterator first, Iterator last, std::size_t size) : m_first(first), m_last(last), m_size(size)
+    {}
+
+    Iterator begin() const { return m_first; }
+    Iterator end() const { return m_last; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    Iterator m_first;
+    Iterator m_last;
+    std::size_t m_size;
+};
+
+
+template<typename T, typename C>
+AdaptorView<typename C::const_iterator> adaptorView(const std::queue<T, C>& q)
+{
+    const auto& c { underlyingContainer(q) };
+    return { c.cbegin(), c.cend(), c.size() };
+}
+
+// Top of the stack is the back of the container: iterate backwards
+template<typename T, typename C>
+AdaptorView<typename C::const_reverse_iterator> adaptorView(const std::stack<T, C>& s)
+{
+    const auto& c { underlyingContainer(s) };
+    return { c.crbegin(), c.crend(), c.size() };
+}
+
+template<typename T, typename C, typename Compare>
+AdaptorView<typename C::const_iterator> adaptorView(const std::priority_queue<T, C, Compare>& pq)
+{
+    const auto& c { underlyingContainer(pq) };
+    return { c.cbegin(), c.cend(), c.size() };
+}
+
+
+// Metaprogramming function to detect adaptors supported by adaptorView
+template<typename T>
+struct is_type_adaptor {
+  static const bool value = false;
+};
+
+template<typename T, typename C>
+struct is_type_adaptor<std::queue<T, C>> {
+  static const bool value = true;
+};
+
+template<typename T, typename C>
+struct is_type_adaptor<std::stack<T, C>> {
+  static const bool value = true;
+};
+
+template<typename T, typename C, typename Compare>
+struct is_type_adaptor<std::priority_queue<T, C, Compare>> {
+  static const bool value = true;
+};
+
+
+#endif // ADAPTORVIEW_H
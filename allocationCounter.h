@@ -0,0 +1,82 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+/*************************************
+ * Counts every heap allocation done through operator new.
+ * Global operator new and delete are replaced by versions that increment counters
+ * and forward to malloc/free.
+ *
+ * IMPORTANT
+ * Replacement functions can't be inline: this header defines them and must be
+ * included by a single source file of the executable (the benchmark main file).
+ * **********************************/
+
+
+struct AllocationCounter {
+    static inline std::atomic<std::size_t> allocations { 0 };
+    static inline std::atomic<std::size_t> bytes { 0 };
+
+    static void reset()
+    {
+        allocations = 0;
+        bytes = 0;
+    }
+};
+
+/// Number of allocations done while running 'f'
+template<typename F>
+std::size_t countAllocations(F&& f)
+{
+    const std::size_t before { AllocationCounter::allocations };
+    f();
+    return AllocationCounter::allocations - before;
+}
+
+
+void* operator new(std::size_t size)
+{
+    AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align { static_cast<std::size_t>(alignment) };
+    // aligned_alloc requires size to be a multiple of the alignment
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,219 @@
+#ifndef ASYNCLOGGER_H
+#define ASYNCLOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "containerFormatter.h"
+#include "lockFreeQueues.h"
+#include "perThread.h"
+
+
+/*************************************
+ * ASYNCHRONOUS LOGGER
+ * cout << threadId() << ... << endl from several threads:
+ * - threadId() builds a stringstream at each call
+ * - endl flushes the stream: one write system call per line
+ * - all threads take the lock of cout, and wait for each other's writes
+ *
+ * AsyncLogger::log(args...):
+ * - thread id text is built once per thread (cachedThreadId)
+ * - the line is formatted into a buffer owned by the thread (numbers with to_chars), no
+ *   allocation once the buffer has grown
+ * - the line is pushed to a ring (SpscQueue) owned by the thread: threads never share a
+ *   ring, pushing is a copy and an index update
+ * - a single writer thread drains all rings and writes their lines by large blocks
+ *   (BufferedWriter), with one flush per block instead of one per line
+ * Lines of a given thread keep their order; lines of different threads may be interleaved
+ * in a different order than they were logged.
+ * Lines longer than Record::maxLength are truncated. When a ring is full, log() waits for the
+ * writer (nothing is lost). flush() waits until everything logged so far is written.
+ * When a thread exits, its ring is retired: the writer frees it once drained (see perThread.h).
+ * **********************************/
+
+
+/// "Thread #<id>", as threadId() in threads.cpp, but built once per thread
+inline const std::string& cachedThreadId()
+{
+    thread_local const std::string id { [] {
+        std::ostringstream st;
+        st << "Thread #" << std::hex << std::this_thread::get_id();
+        return st.str();
+    }() };
+    return id;
+}
+
+
+class AsyncLogger
+{
+public:
+    explicit AsyncLogger(std::ostream& out = std::cout, std::size_t ringCapacity = 1024)
+        : m_out(out), m_ringCapacity(ringCapacity), m_writer(&AsyncLogger::writeLoop, this)
+    {}
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    /// Remaining lines are written. No thread may log any more.
+    ~AsyncLogger()
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_stop = true;
+        }
+        m_wakeUp.notify_one();
+        m_writer.join();
+    }
+
+    /// Logs one line: thread id, then all arguments (numbers, text, or anything with an operator<<)
+    template<typename... Args>
+    void log(const Args&... args)
+    {
+        auto& line { lineBuffer() };
+        line.assign(cachedThreadId());
+        line += ": ";
+        (append(line, args), ...);
+        line += '\n';
+
+        Record record;
+        record.length = static_cast<std::uint16_t>(std::min(line.size(), Record::maxLength));
+        line.copy(record.text, record.length);
+        if (record.length < line.size())
+            record.text[record.length - 1] = '\n';
+        threadRing().push(record);
+    }
+
+    /// Waits until all lines logged before the call are written and the stream is flushed
+    void flush()
+    {
+        std::unique_lock lock { m_mutex };
+        const auto ticket { ++m_flushRequests };
+        m_wakeUp.notify_one();
+        m_flushed.wait(lock, [&] { return m_flushesDone >= ticket; });
+    }
+
+private:
+    struct Record
+    {
+        static constexpr std::size_t maxLength { 256 - sizeof(std::uint16_t) };
+        std::uint16_t length { 0 };
+        char text[maxLength];
+    };
+
+    using Ring = SpscQueue<Record>;
+    using ThreadRing = PerThread<Ring>::Slot;
+
+    static std::string& lineBuffer()
+    {
+        thread_local std::string line;
+        return line;
+    }
+
+    template<typename T>
+    static void append(std::string& line, const T& value)
+    {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            line += std::string_view(value);
+        else if constexpr (std::is_same_v<T, char>)
+            line += value;
+        else if constexpr (std::is_same_v<T, bool>)
+            line += value ? "true" : "false";
+        else if constexpr (std::is_arithmetic_v<T>) {
+            char digits[64];
+            const auto result { std::to_chars(digits, digits + sizeof(digits), value) };
+            line.append(digits, result.ptr);
+        }
+        else {
+            thread_local std::ostringstream st;
+            st.str({});
+            st << value;
+            line += st.view();
+        }
+    }
+
+    /// Ring of the calling thread for this logger, created at its first log
+    Ring& threadRing()
+    {
+        return m_threadRings.local([this](std::shared_ptr<ThreadRing> ring) {
+            std::lock_guard lock { m_mutex };
+            m_newRings.push_back(std::move(ring));
+        }, m_ringCapacity);
+    }
+
+    void writeLoop()
+    {
+        BufferedWriter writer { m_out };
+        std::vector<Record> records(64);
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        while (true) {
+            std::size_t flushRequests;
+            {
+                std::lock_guard lock { m_mutex };
+                flushRequests = m_flushRequests;
+                std::move(m_newRings.begin(), m_newRings.end(), std::back_inserter(rings));
+                m_newRings.clear();
+            }
+
+            std::size_t written { 0 };
+            for (auto ring { rings.begin() }; ring != rings.end();) {
+                // Read before draining: a retired ring found empty afterwards gets no more lines
+                const bool retired { (*ring)->retired.load(std::memory_order_acquire) };
+                while (const auto popped { (*ring)->value.try_pop_batch(records.begin(), records.size()) }) {
+                    for (std::size_t r { 0 }; r < popped; r++)
+                        writer.put(std::string_view(records[r].text, records[r].length));
+                    written += popped;
+                }
+                ring = retired ? rings.erase(ring) : ring + 1;
+            }
+            if (written) {
+                writer.flush();
+                m_out.flush();
+            }
+
+            // Every ring was drained after the flush requests were made: lines logged before
+            // them are written, even if other threads keep logging
+            std::unique_lock lock { m_mutex };
+            if (m_flushesDone < flushRequests) {
+                m_flushesDone = flushRequests;
+                m_flushed.notify_all();
+            }
+            if (written)
+                continue;
+            if (m_stop)
+                return;
+            // Nothing to write: polls rings again after a short delay, or at once on flush request
+            m_wakeUp.wait_for(lock, std::chrono::milliseconds(1),
+                              [this] { return m_stop || m_flushRequests > m_flushesDone; });
+        }
+    }
+
+    std::ostream& m_out;
+    const std::size_t m_ringCapacity;
+    PerThread<Ring> m_threadRings;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_flushed;
+    std::vector<std::shared_ptr<ThreadRing>> m_newRings;   // rings created since the writer last looked
+    std::size_t m_flushRequests { 0 };
+    std::size_t m_flushesDone { 0 };
+    bool m_stop { false };
+    std::thread m_writer;
+};
+
+
+#endif // ASYNCLOGGER_H
@@ -0,0 +1,62 @@
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <stack>
+
+#include "allocationCounter.h"
+#include "benchmark.h"
+#include "containerFormatter.h"
+#include "metaprogramming.h"
+
+using namespace std;
+
+
+/// Previous queue printer from metaprogramming.h: takes a copy of the queue and pops every item
+template<typename T, typename U>
+ostream& printByValue(ostream& os, queue<T, U> container)
+{
+    os << "Size: " << container.size() << " / ";
+    os << "Items: ";
+    while (!container.empty()) {
+        os << container.front() << " ";
+        container.pop();
+    }
+    return os;
+}
+
+template<typename F>
+void run(const string& name, size_t n, F&& print)
+{
+    const double time { measureBest(print, 3) };
+    const size_t allocations { countAllocations(print) };
+    printRow(name, n, time * 1e3, allocations);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+    ofstream sink("/dev/null");
+
+    cout << "Printing adaptors (times in ms)" << endl;
+    printHeader({ "printer", "items", "time", "allocations" });
+
+    for (auto n : decades(1000, maxSize)) {
+        queue<int> q;
+        stack<int> st;
+        priority_queue<int> pq;
+        for (size_t i { 0 }; i < n; i++) {
+            q.push(static_cast<int>(i));
+            st.push(static_cast<int>(i));
+            pq.push(static_cast<int>(i));
+        }
+
+        run("queue copy+pop", n, [&]{ printByValue(sink, q); sink.flush(); });
+        run("queue view", n, [&]{ sink << q; sink.flush(); });
+        run("queue writer", n, [&]{ BufferedWriter out(sink); out << q; });
+        run("stack view", n, [&]{ sink << st; sink.flush(); });
+        run("prio view", n, [&]{ sink << pq; sink.flush(); });
+    }
+
+    return 0;
+}
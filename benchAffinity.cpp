@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "cpuTopology.h"
+
+using namespace std;
+
+
+/// Arrays of one worker for the triad loop a = b + s * c
+struct WorkerArrays
+{
+    unique_ptr<double[]> a, b, c;
+
+    explicit WorkerArrays(size_t size)
+        : a(allocateLocal<double>(size)), b(allocateLocal<double>(size)), c(allocateLocal<double>(size))
+    {
+        fill_n(b.get(), size, 1.0);
+        fill_n(c.get(), size, 2.0);
+    }
+};
+
+/// Memory bound parallel loop: each worker runs 'passes' triads over its own arrays.
+/// 'placement': CPU of each worker, none for unpinned workers.
+/// 'localArrays': arrays allocated by the workers (first touch), otherwise by the calling thread.
+/// Returns the bandwidth of all workers together in GB/s.
+double triad(unsigned workers, size_t size, int passes, const optional<vector<unsigned>>& placement, bool localArrays)
+{
+    vector<unique_ptr<WorkerArrays>> arrays(workers);
+    if (!localArrays)
+        for (auto& worker : arrays)
+            worker = make_unique<WorkerArrays>(size);
+
+    latch ready { workers };
+    latch start { 1 };
+    vector<thread> threads;
+    for (unsigned w { 0 }; w < workers; w++)
+        threads.emplace_back([&, w] {
+            if (placement)
+                pinCurrentThread((*placement)[w]);
+            if (localArrays)
+                arrays[w] = make_unique<WorkerArrays>(size);
+            ready.count_down();
+            start.wait();
+            auto& [a, b, c] { *arrays[w] };
+            for (int pass { 0 }; pass < passes; pass++) {
+                for (size_t i { 0 }; i < size; i++)
+                    a[i] = b[i] + 3.0 * c[i];
+                doNotOptimize(a[pass % size]);
+            }
+        });
+
+    ready.wait();
+    const auto begin { chrono::steady_clock::now() };
+    start.count_down();
+    for (auto& thread : threads)
+        thread.join();
+    const chrono::duration<double> time { chrono::steady_clock::now() - begin };
+    // Each triad reads 2 arrays and writes 1
+    return 3.0 * sizeof(double) * static_cast<double>(size) * passes * workers / time.count() / 1e9;
+}
+
+
+int main(int argc, char** argv)
+{
+    // Total size of the arrays of all workers, far beyond caches
+    const auto totalBytes { maxSizeFromArgs(argc, argv, 384'000'000) };
+    const auto topology { CpuTopology::detect() };
+    const auto workers { static_cast<unsigned>(topology.cpus().size()) };
+    const auto size { totalBytes / 3 / sizeof(double) / workers };
+    const int passes { 10 };
+
+    cout << "Topology: " << topology.cpus().size() << " logical CPUs, " << topology.physicalCoreCount()
+         << " physical cores, " << topology.nodeCount() << " NUMA nodes" << endl;
+    cout << "Triad a = b + 3c, " << workers << " workers, " << totalBytes / 1'000'000 << "MB of arrays in total (GB/s)" << endl;
+    printHeader({ "workers", "arrays", "GB/s" });
+
+    printRow("unpinned", "main", triad(workers, size, passes, nullopt, false));
+    printRow("unpinned", "local", triad(workers, size, passes, nullopt, true));
+    printRow("compact", "main", triad(workers, size, passes, topology.place(workers, Placement::Compact), false));
+    printRow("compact", "local", triad(workers, size, passes, topology.place(workers, Placement::Compact), true));
+    printRow("scatter", "local", triad(workers, size, passes, topology.place(workers, Placement::Scatter), true));
+    const auto cores { topology.physicalCoreCount() };
+    printRow("cores", "local", triad(cores, size * workers / cores, passes, topology.place(cores, Placement::PhysicalCores), true));
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <array>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "allocationCounter.h"
+#include "benchmark.h"
+#include "stringConcat.h"
+
+using namespace std;
+
+
+constexpr int iterations { 100'000 };
+constexpr size_t maxPieces { 32 };
+
+/// Pieces of 1 to 12 characters: the result outgrows the small string buffer after a few pieces
+array<string, maxPieces> makePieces()
+{
+    array<string, maxPieces> pieces;
+    for (size_t i { 0 }; i < maxPieces; i++)
+        pieces[i] = string(1 + i % 12, static_cast<char>('a' + i % 26));
+    return pieces;
+}
+
+/// Builds the string 'iterations' times: ns and allocations per string
+template<typename F>
+pair<double, double> measure(F build)
+{
+    auto workload = [&] {
+        for (int i { 0 }; i < iterations; i++) {
+            const string result { build() };
+            doNotOptimize(result.data());
+        }
+    };
+    const double time { measureBest(workload) };
+    const double allocations { static_cast<double>(countAllocations(workload)) / iterations };
+    return { time / iterations * 1e9, allocations };
+}
+
+/// Concatenates the N first pieces with each method
+template<size_t... I>
+void run(const array<string, maxPieces>& pieces, index_sequence<I...>)
+{
+    auto row = [](const string& method, pair<double, double> result) { printRow(method, sizeof...(I), result.first, result.second); };
+
+    // ((p0 + p1) + p2) + ...: the first + allocates, the next ones grow the temporary
+    row("operator+", measure([&] { return (... + pieces[I]); }));
+    // Each piece added to a named string: same growth
+    row("append", measure([&] {
+        string result;
+        (result.append(pieces[I]), ...);
+        return result;
+    }));
+    row("ostringstream", measure([&] {
+        ostringstream stream;
+        (stream << ... << pieces[I]);
+        return stream.str();
+    }));
+    row("concat", measure([&]() -> string { return concat(pieces[I]...); }));
+}
+
+
+int main()
+{
+    const auto pieces { makePieces() };
+
+    cout << "Concatenation of 2 to 32 strings of 1 to 12 chars: ns and allocations per result" << endl;
+    printHeader({ "method", "pieces", "ns", "allocations" });
+    run(pieces, make_index_sequence<2> {});
+    run(pieces, make_index_sequence<4> {});
+    run(pieces, make_index_sequence<8> {});
+    run(pieces, make_index_sequence<16> {});
+    run(pieces, make_index_sequence<32> {});
+
+    // Mixed pieces: strings, a string_view, literals and chars in one expression
+    const string first { "first" };
+    const string_view second { "second" };
+    const auto mixed { measure([&]() -> string { return concat(first, " - ", second) + ", " + 'x' + first; }) };
+    cout << endl << "Mixed string, string_view, literals and chars: " << mixed.first << " ns, " << mixed.second << " allocations" << endl;
+
+    return 0;
+}
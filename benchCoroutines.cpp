@@ -0,0 +1,136 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "coroutineTask.h"
+
+using namespace std;
+
+
+void printResult(const string& version, const string& operation, size_t count, double seconds)
+{
+    printRow(version, operation, count, seconds / static_cast<double>(count) * 1e9);
+}
+
+task<long> immediateValue(long i)
+{
+    co_return i;
+}
+
+/// Value produced and consumed in the same thread: overhead of the mechanism alone
+void benchAwait(size_t count, CoroutineExecutor& executor)
+{
+    printResult("future", "get", count, measureBest([&] {
+        long total { 0 };
+        for (size_t i { 0 }; i < count; i++) {
+            promise<long> p;
+            auto f { p.get_future() };
+            p.set_value(static_cast<long>(i));
+            total += f.get();
+        }
+        doNotOptimize(total);
+    }, 3));
+
+    auto awaitLoop = [](size_t n) -> task<long> {
+        long total { 0 };
+        for (size_t i { 0 }; i < n; i++)
+            total += co_await immediateValue(static_cast<long>(i));
+        co_return total;
+    };
+    printResult("task", "co_await", count, measureBest([&] { doNotOptimize(executor.syncWait(awaitLoop(count))); }, 3));
+}
+
+/// Ping pong: each side waits for the value of the other one before sending the next one
+void benchPingPong(size_t count, CoroutineExecutor& executor)
+{
+    printResult("future", "ping-pong", count, measureBest([&] {
+        vector<promise<long>> pings(count), pongs(count);
+        thread other { [&] {
+            for (size_t i { 0 }; i < count; i++)
+                pongs[i].set_value(pings[i].get_future().get() + 1);
+        } };
+        long total { 0 };
+        for (size_t i { 0 }; i < count; i++) {
+            pings[i].set_value(static_cast<long>(i));
+            total += pongs[i].get_future().get();
+        }
+        other.join();
+        doNotOptimize(total);
+    }, 3));
+
+    // Coroutine waiting for a ping is resumed by the coroutine sending it: no thread switch
+    auto pong = [](vector<AsyncPromise<long>>& pings, vector<AsyncPromise<long>>& pongs, AsyncPromise<void> done) -> task<> {
+        for (size_t i { 0 }; i < pings.size(); i++)
+            pongs[i].set_value(co_await pings[i].get_future() + 1);
+        done.set_value();
+    };
+    auto ping = [&](vector<AsyncPromise<long>>& pings, vector<AsyncPromise<long>>& pongs) -> task<long> {
+        AsyncPromise<void> done;
+        auto pongDone { done.get_future() };
+        executor.spawn(pong(pings, pongs, move(done)));
+        long total { 0 };
+        for (size_t i { 0 }; i < pings.size(); i++) {
+            pings[i].set_value(static_cast<long>(i));
+            total += co_await pongs[i].get_future();
+        }
+        // Vectors must outlive the other coroutine
+        co_await pongDone;
+        co_return total;
+    };
+    printResult("task", "ping-pong", count, measureBest([&] {
+        vector<AsyncPromise<long>> pings(count), pongs(count);
+        doNotOptimize(executor.syncWait(ping(pings, pongs)));
+    }, 3));
+}
+
+/// Many waits in flight at once: a thread per wait vs coroutines sleeping on the executor
+void benchSleeps(size_t count, CoroutineExecutor& executor)
+{
+    constexpr auto delay { 10ms };
+    const double threadsTime { measureBest([&] {
+        vector<thread> threads;
+        threads.reserve(count);
+        for (size_t i { 0 }; i < count; i++)
+            threads.emplace_back([delay] { this_thread::sleep_for(delay); });
+        for (auto& t : threads)
+            t.join();
+    }, 3) };
+    printResult("thread", "sleep 10ms", count, threadsTime);
+
+    // Last sleeper to wake up fulfills the promise awaited by sleepAll
+    auto sleeper = [&executor, delay](atomic<size_t>& remaining, AsyncPromise<void>& done) -> task<> {
+        co_await executor.sleepFor(delay);
+        if (remaining.fetch_sub(1) == 1)
+            done.set_value();
+    };
+    auto sleepAll = [&](size_t n) -> task<> {
+        atomic<size_t> remaining { n };
+        AsyncPromise<void> done;
+        auto allAwake { done.get_future() };
+        for (size_t i { 0 }; i < n; i++)
+            executor.spawn(sleeper(remaining, done));
+        co_await allAwake;
+    };
+    printResult("task", "sleep 10ms", count, measureBest([&] { executor.syncWait(sleepAll(count)); }, 3));
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto count { maxSizeFromArgs(argc, argv, 100'000) };
+    CoroutineExecutor executor(2);
+
+    cout << "Time per operation (ns). 'sleep' is the total time divided by the number of waits in flight" << endl;
+    printHeader({ "version", "operation", "count", "ns/op" });
+
+    benchAwait(count, executor);
+    benchPingPong(count, executor);
+    benchSleeps(min<size_t>(count, 1000), executor);
+
+    return 0;
+}
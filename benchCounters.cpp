@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "sharedCounters.h"
+
+using namespace std;
+
+
+/// 'threads' threads increment the same counter 'increments' times each, all starting together
+template<typename Counter>
+void benchCounter(const string& name, unsigned threads, size_t increments)
+{
+    long total { 0 };
+    const double time { measureBest([&]{
+        Counter counter;
+        latch start { threads };
+        vector<thread> workers;
+        for (unsigned t { 0 }; t < threads; t++)
+            workers.emplace_back([&] {
+                start.arrive_and_wait();
+                for (size_t i { 0 }; i < increments; i++)
+                    ++counter;
+            });
+        for (auto& worker : workers)
+            worker.join();
+        total = counter.value();
+    }, 3) };
+    if (total != static_cast<long>(threads * increments))
+        cerr << name << ": lost increments (" << total << ")" << endl;
+    printRow(name, threads, static_cast<double>(threads * increments) / time / 1e6);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto increments { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    cout << "Counter throughput (million increments/s, all threads together), " << increments << " increments per thread" << endl;
+    printHeader({ "counter", "threads", "Mincr/s" });
+
+    for (auto threads : threadCounts()) {
+        benchCounter<MutexCounter>("mutex", threads, increments);
+        benchCounter<AtomicCounter>("atomic", threads, increments);
+        // Shards packed in the same cache lines: false sharing
+        benchCounter<ShardedCounter<sizeof(long)>>("shards packed", threads, increments);
+        benchCounter<ShardedCounter<>>("shards padded", threads, increments);
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "benchmark.h"
+#include "fixedVector.h"
+
+using namespace std;
+
+
+/// Operators returning a new vector: one loop and one temporary per operator
+template<typename T, size_t N>
+struct NaiveVector
+{
+    array<T, N> values {};
+
+    friend NaiveVector operator+(const NaiveVector& a, const NaiveVector& b)
+    {
+        NaiveVector result;
+        for (size_t i { 0 }; i < N; i++)
+            result.values[i] = a.values[i] + b.values[i];
+        return result;
+    }
+
+    friend NaiveVector operator*(const NaiveVector& a, const NaiveVector& b)
+    {
+        NaiveVector result;
+        for (size_t i { 0 }; i < N; i++)
+            result.values[i] = a.values[i] * b.values[i];
+        return result;
+    }
+
+    friend T dot(const NaiveVector& a, const NaiveVector& b)
+    {
+        T total { 0 };
+        for (size_t i { 0 }; i < N; i++)
+            total += a.values[i] * b.values[i];
+        return total;
+    }
+};
+
+/// Runs 'operation' enough times to process about a million items: ns per operation
+template<size_t N, typename F>
+double timeOf(F operation)
+{
+    constexpr size_t repeat { N < (1 << 20) ? (1 << 20) / N : 1 };
+    return measureBest([&] {
+        for (size_t i { 0 }; i < repeat; i++)
+            operation();
+    }) / repeat * 1e9;
+}
+
+template<size_t N>
+void run()
+{
+    using T = double;
+    array<T, N> a, b, c, r;
+    NaiveVector<T, N> na, nb, nc, nr;
+    FixedVector<T, N> fa, fb, fc, fr;
+    for (size_t i { 0 }; i < N; i++) {
+        a[i] = na.values[i] = fa[i] = 1.0 + static_cast<T>(i % 7);
+        b[i] = nb.values[i] = fb[i] = 0.5 + static_cast<T>(i % 3);
+        c[i] = nc.values[i] = fc[i] = 0.25 * static_cast<T>(i % 5);
+    }
+    // The clobber in doNotOptimize makes the compiler reload inputs on each run
+    doNotOptimize(a);
+    doNotOptimize(na);
+    doNotOptimize(fa);
+
+    auto row = [](const string& operation, double loop, double naive, double expression) {
+        printRow(operation, N, loop, naive, expression);
+    };
+
+    row("a*b + c", timeOf<N>([&] {
+            for (size_t i { 0 }; i < N; i++)
+                r[i] = a[i] * b[i] + c[i];
+            doNotOptimize(r);
+        }),
+        timeOf<N>([&] {
+            nr = na * nb + nc;
+            doNotOptimize(nr);
+        }),
+        timeOf<N>([&] {
+            fr = fa * fb + fc;
+            doNotOptimize(fr);
+        }));
+
+    row("dot", timeOf<N>([&] {
+            T total { 0 };
+            for (size_t i { 0 }; i < N; i++)
+                total += a[i] * b[i];
+            doNotOptimize(total);
+        }),
+        timeOf<N>([&] { doNotOptimize(dot(na, nb)); }),
+        timeOf<N>([&] { doNotOptimize(dot(fa, fb)); }));
+
+    row("norm(a+b)", timeOf<N>([&] {
+            T total { 0 };
+            for (size_t i { 0 }; i < N; i++)
+                total += (a[i] + b[i]) * (a[i] + b[i]);
+            doNotOptimize(sqrt(total));
+        }),
+        timeOf<N>([&] {
+            const auto sum { na + nb };
+            doNotOptimize(sqrt(dot(sum, sum)));
+        }),
+        timeOf<N>([&] { doNotOptimize(norm(fa + fb)); }));
+}
+
+
+int main()
+{
+    cout << "Fixed size vectors of doubles, " << vector_detail::registerBytes << " bytes SIMD registers: ns per operation" << endl;
+    printHeader({ "operation", "size", "loop", "naive ops", "expression" });
+    run<3>();
+    run<4>();
+    run<16>();
+    run<64>();
+    run<256>();
+    run<1024>();
+
+    return 0;
+}
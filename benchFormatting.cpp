@@ -0,0 +1,52 @@
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "containerFormatter.h"
+#include "metaprogramming.h"
+
+using namespace std;
+
+
+/// Compares operator<< from metaprogramming.h with BufferedWriter.
+/// Output goes to /dev/null: the kernel write is part of the measure, as it is in real life.
+template<typename T>
+void compare(const string& name, const T& container, ofstream& sink)
+{
+    double streamTime { measureBest([&]{ sink << container; sink.flush(); }, 3) };
+    double writerTime { measureBest([&]{ BufferedWriter out(sink); out << container; }, 3) };
+    printRow(name, container.size(), streamTime * 1e3, writerTime * 1e3, streamTime / writerTime);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+    ofstream sink("/dev/null");
+
+    cout << "operator<< vs BufferedWriter (times in ms)" << endl;
+    printHeader({ "container", "items", "operator<<", "writer", "speedup" });
+
+    for (auto n : decades(1000, maxSize)) {
+        vector<double> vec(n);
+        for (size_t i { 0 }; i < n; i++)
+            vec[i] = static_cast<double>(i) / 7.0;
+        compare("vector<double>", vec, sink);
+
+        list<int> l;
+        for (size_t i { 0 }; i < n; i++)
+            l.push_back(static_cast<int>(i));
+        compare("list<int>", l, sink);
+
+        map<string, int> m;
+        for (size_t i { 0 }; i < n; i++)
+            m.emplace("key" + to_string(i), static_cast<int>(i));
+        compare("map<str,int>", m, sink);
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <array>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "allocationCounter.h"
+#include "benchmark.h"
+#include "uniqueFunction.h"
+
+using namespace std;
+
+
+constexpr int iterations { 1'000'000 };
+
+/// Wraps 'callable' in a W and calls it once, 'iterations' times: ns and allocations per construction
+template<typename W, typename F>
+pair<double, double> construction(const F& callable)
+{
+    auto workload = [&] {
+        long total { 0 };
+        for (int i { 0 }; i < iterations; i++) {
+            W wrapper { callable };
+            total += wrapper(i);
+        }
+        doNotOptimize(total);
+    };
+    const double time { measureBest(workload) };
+    const double allocations { static_cast<double>(countAllocations(workload)) / iterations };
+    return { time / iterations * 1e9, allocations };
+}
+
+/// Calls the same W 'iterations' times: ns per call
+template<typename W, typename F>
+double invocation(const F& callable)
+{
+    W wrapper { callable };
+    return measureBest([&] {
+        long total { 0 };
+        for (int i { 0 }; i < iterations; i++)
+            total += wrapper(i);
+        doNotOptimize(total);
+    }) / iterations * 1e9;
+}
+
+template<typename F>
+void run(const string& captures, const F& callable)
+{
+    using Signature = long(int);
+    auto row = [&]<typename W>(const string& name, W*) {
+        const auto [constructNs, allocations] { construction<W>(callable) };
+        printRow(captures, name, constructNs, invocation<W>(callable), allocations);
+    };
+    // Direct call: the lambda itself, the compiler may inline it
+    row("lambda", static_cast<F*>(nullptr));
+    row("std::function", static_cast<function<Signature>*>(nullptr));
+    row("unique_func", static_cast<unique_function<Signature>*>(nullptr));
+    row("function_ref", static_cast<function_ref<Signature>*>(nullptr));
+}
+
+
+int main()
+{
+    cout << "Type erased callables: construction (+ 1 call) and call cost in ns, allocations per construction" << endl;
+    cout << "unique_function stores up to 24 bytes inline, std::function (libstdc++) 16 bytes" << endl;
+    printHeader({ "captures", "wrapper", "construct", "call", "allocations" });
+
+    long a { 1 }, b { 2 }, c { 3 };
+    run("1 reference", [&a](int i) { return a + i; });
+    run("3 references", [&a, &b, &c](int i) { return a + b + c + i; });
+    const array<long, 8> values { 1, 2, 3, 4, 5, 6, 7, 8 };
+    run("64 bytes", [values](int i) { return values[static_cast<size_t>(i) % values.size()] + i; });
+
+    return 0;
+}
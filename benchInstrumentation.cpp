@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+
+/// Samples kept by hand: every thread appends to the same vector under a mutex
+class LockedSamples
+{
+public:
+    void record(uint64_t value)
+    {
+        lock_guard lock { m_mutex };
+        m_values.push_back(value);
+    }
+
+private:
+    mutex m_mutex;
+    vector<uint64_t> m_values;
+};
+
+/// 'threads' threads call 'sample(recorder, i)' 'samples' times each, prints ns per sample
+template<typename Recorder, typename Sample>
+void benchSamples(const string& name, unsigned threads, size_t samples, Sample sample)
+{
+    const double time { measureBest([&] {
+        Recorder recorder;
+        latch start { threads };
+        vector<thread> workers;
+        for (unsigned t { 0 }; t < threads; t++)
+            workers.emplace_back([&] {
+                start.arrive_and_wait();
+                for (size_t i { 0 }; i < samples; i++)
+                    sample(recorder, i);
+            });
+        for (auto& worker : workers)
+            worker.join();
+    }, 3) };
+    // Per thread cost: threads run in parallel
+    printRow(name, threads, time * 1e9 / static_cast<double>(samples));
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto samples { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    cout << "Cost of recording a sample (ns per sample, per thread), " << samples << " samples per thread" << endl;
+    cout << "'clock pair' is the cost of the 2 now() of a timer alone, 'scoped timer' includes them" << endl;
+    printHeader({ "recorder", "threads", "ns/sample" });
+
+    // Values spread over many buckets, as latencies are
+    auto value = [](size_t i) { return static_cast<uint64_t>((i * 2654435761u) & 0xFFFFF); };
+    for (auto threads : threadCounts()) {
+        benchSamples<LockedSamples>("mutex vector", threads, samples, [&](LockedSamples& r, size_t i) { r.record(value(i)); });
+        benchSamples<LatencyHistogram>("histogram", threads, samples, [&](LatencyHistogram& h, size_t i) { h.record(value(i)); });
+        benchSamples<LatencyHistogram>("clock pair", threads, samples, [](LatencyHistogram&, size_t) {
+            const auto start { chrono::steady_clock::now() };
+            doNotOptimize(chrono::steady_clock::now() - start);
+        });
+        benchSamples<LatencyHistogram>("scoped timer", threads, samples, [](LatencyHistogram& h, size_t) { ScopedTimer timer { h }; });
+    }
+
+    // Precision check: uniform values in [0, 1e6), exact percentiles are known
+    LatencyHistogram uniform;
+    for (uint64_t v { 0 }; v < 1'000'000; v++)
+        uniform.record(v);
+    const auto h { uniform.snapshot() };
+    cout << endl << "Uniform [0, 1e6): p50=" << h.percentile(50) << " (exact 499999) p99=" << h.percentile(99)
+         << " (exact 989999) p999=" << h.percentile(99.9) << " (exact 998999) max=" << h.max() << endl;
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "join.h"
+
+using namespace std;
+
+
+/// Line built as in containers.cpp: a new string at each step, O(n²)
+string accumulateLine(const vector<double>& vec)
+{
+    return accumulate(vec.begin(), vec.end(), std::string(),
+        [](const auto previous, const auto item){
+        if (previous.empty())
+                return std::to_string(item);
+        else
+                return previous + " " + std::to_string(item);
+        });
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 100'000) };
+    // Quadratic version takes minutes above that size
+    constexpr size_t maxAccumulateSize { 100'000 };
+
+    cout << "Building a space separated line: accumulate vs join (times in ms)" << endl;
+    printHeader({ "items", "accumulate", "join", "joinTo", "speedup" });
+
+    string line;
+    for (auto n : decades(10, maxSize)) {
+        vector<double> vec(n);
+        for (size_t i { 0 }; i < n; i++)
+            vec[i] = static_cast<double>(i) / 7.0;
+
+        const double joinTime { measureBest([&]{ doNotOptimize(join(vec).size()); }) };
+        // Same buffer reused from one line to the next: no allocation at all
+        const double joinToTime { measureBest([&]{ line.clear(); doNotOptimize(joinTo(line, vec).size()); }) };
+        if (n <= maxAccumulateSize) {
+            const double accumulateTime { measureBest([&]{ doNotOptimize(accumulateLine(vec).size()); }, n < 10'000 ? 5 : 1) };
+            printRow(n, accumulateTime * 1e3, joinTime * 1e3, joinToTime * 1e3, accumulateTime / joinTime);
+        }
+        else
+            printRow(n, "skipped", joinTime * 1e3, joinToTime * 1e3, "");
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asyncLogger.h"
+#include "benchmark.h"
+
+using namespace std;
+
+
+/// Same as threadId() in threads.cpp: new stringstream at each call
+std::string threadId()
+{
+    stringstream st;
+    st << "Thread #" << std::hex << this_thread::get_id() << std::dec;
+    return st.str();
+}
+
+/// Runs 'log(i)' 'lines' times on each of 'threads' threads, returns the duration in seconds
+template<typename Log>
+double logFromThreads(unsigned threads, size_t lines, Log log)
+{
+    const auto start { chrono::steady_clock::now() };
+    vector<thread> workers;
+    for (unsigned t { 0 }; t < threads; t++)
+        workers.emplace_back([&] {
+            for (size_t i { 0 }; i < lines; i++)
+                log(i);
+        });
+    for (auto& worker : workers)
+        worker.join();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/// Runs f with cout writing to 'out', as a program redirected to a file
+template<typename F>
+double withCoutTo(std::ostream& out, F f)
+{
+    auto* coutBuffer { cout.rdbuf(out.rdbuf()) };
+    const double seconds { f() };
+    cout.rdbuf(coutBuffer);
+    return seconds;
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto lines { maxSizeFromArgs(argc, argv, 200'000) };
+    // Lines go to a file: a terminal would measure the terminal
+    const char* logFile { "benchLogger.log" };
+    ofstream out { logFile };
+
+    cout << "Logging " << lines << " lines per thread, million calls/s per thread\n"
+         << "'async' only counts log calls, 'async+drain' waits until all lines are written\n";
+    printHeader({ "logger", "threads", "Mcalls/s" });
+    auto rate = [&](double seconds) { return static_cast<double>(lines) / seconds / 1e6; };
+
+    for (auto threads : threadCounts()) {
+        const double coutSeconds { withCoutTo(out, [&] {
+            return logFromThreads(threads, lines, [](size_t i) {
+                cout << threadId() << ": value " << i << " ratio " << 0.5 << endl;
+            });
+        }) };
+        printRow("cout endl", threads, rate(coutSeconds));
+
+        AsyncLogger logger { out };
+        const double callSeconds { logFromThreads(threads, lines, [&](size_t i) {
+            logger.log("value ", i, " ratio ", 0.5);
+        }) };
+        const auto start { chrono::steady_clock::now() };
+        logger.flush();
+        const double drainSeconds { callSeconds + chrono::duration<double>(chrono::steady_clock::now() - start).count() };
+        printRow("async", threads, rate(callSeconds));
+        printRow("async+drain", threads, rate(drainSeconds));
+    }
+
+    out.close();
+    std::remove(logFile);
+    return 0;
+}
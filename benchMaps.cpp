@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark.h"
+#include "flatMap.h"
+#include "openHashMap.h"
+
+using namespace std;
+
+
+/// Inserting one by one in random order moves half the flat_map per item (O(n²)): above this
+/// size, flat_map is built from the keys sorted first, then appended in order
+constexpr size_t flatMapIncrementalLimit { 10'000 };
+
+
+/// Same operations as containers.cpp, on a map<string,int> of n items.
+/// Lookups use 'const char*' keys, as m.find("foo") does.
+/// With 'sortedBulk', insertion sorts the keys (included in the time), then appends them in order.
+template<typename Map>
+void benchMap(const string& name, const vector<string>& keys, const vector<string>& missing, bool sortedBulk = false)
+{
+    const size_t n { keys.size() };
+    auto perItem = [n](double seconds) { return seconds / static_cast<double>(n) * 1e9; };
+
+    Map m;
+    const double insertTime { measureBest([&]{
+        m = Map();
+        if (sortedBulk) {
+            vector<pair<const char*, int>> items;
+            items.reserve(n);
+            for (size_t i { 0 }; i < n; i++)
+                items.emplace_back(keys[i].c_str(), static_cast<int>(i));
+            sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return strcmp(a.first, b.first) < 0; });
+            for (const auto& [key, value] : items)
+                m.emplace_hint(m.end(), key, value);
+        }
+        else
+            for (size_t i { 0 }; i < n; i++)
+                m[keys[i].c_str()] = static_cast<int>(i);
+    }, 3) };
+
+    // Keys looked up in random order
+    vector<const char*> hits;
+    vector<const char*> misses;
+    for (size_t i { 0 }; i < n; i++) {
+        hits.push_back(keys[(i * 7919) % n].c_str());
+        misses.push_back(missing[(i * 7919) % n].c_str());
+    }
+
+    const double hitTime { measureBest([&]{
+        long total { 0 };
+        for (auto key : hits)
+            total += m.find(key)->second;
+        doNotOptimize(total);
+    }) };
+    const double missTime { measureBest([&]{
+        size_t total { 0 };
+        for (auto key : misses)
+            total += m.count(key);
+        doNotOptimize(total);
+    }) };
+    const double iterationTime { measureBest([&]{
+        long total { 0 };
+        for (const auto& item : m)
+            total += item.second;
+        doNotOptimize(total);
+    }) };
+
+    printRow(name, n, perItem(insertTime), perItem(hitTime), perItem(missTime), perItem(iterationTime));
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 1'000'000) };
+
+    cout << "map<string,int> operations (ns per item)" << endl;
+    cout << "flat_map above " << flatMapIncrementalLimit << " items: built from sorted keys ('flat_map bulk'),"
+         << " inserting one by one in random order is O(n^2)" << endl;
+    printHeader({ "map", "items", "insert", "hit", "miss", "iterate" });
+
+    for (auto n : decades(1000, maxSize)) {
+        // Keys inserted in random order
+        vector<string> keys;
+        vector<string> missing;
+        for (size_t i { 0 }; i < n; i++) {
+            keys.push_back("key" + to_string(i));
+            missing.push_back("missing" + to_string(i));
+        }
+        shuffle(keys.begin(), keys.end(), mt19937 { 42 });
+
+        benchMap<map<string, int>>("std::map", keys, missing);
+        benchMap<unordered_map<string, int>>("unordered_map", keys, missing);
+        if (n <= flatMapIncrementalLimit)
+            benchMap<flat_map<string, int>>("flat_map", keys, missing);
+        else
+            benchMap<flat_map<string, int>>("flat_map bulk", keys, missing, true);
+        benchMap<open_hash_map<string, int>>("open_hash_map", keys, missing);
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+#include "benchmark.h"
+#include "memoryResources.h"
+
+using namespace std;
+
+
+/// Builds then destroys a list and a map of n nodes, memory taken from 'resource'
+/// (nullptr: standard containers with the default allocator)
+template<typename List, typename Map>
+void buildAndDestroy(size_t n, pmr::memory_resource* resource)
+{
+    List l { typename List::allocator_type(resource) };
+    for (size_t i { 0 }; i < n; i++)
+        l.push_back(static_cast<int>(i));
+    Map m { typename Map::allocator_type(resource) };
+    for (size_t i { 0 }; i < n; i++)
+        m.emplace(to_string(i), static_cast<int>(i));
+    doNotOptimize(l.size() + m.size());
+}
+
+/// Runs the workload on a fresh resource built by 'makeResource' on top of a statistics resource
+template<typename MakeResource>
+void run(const string& name, size_t n, MakeResource&& makeResource)
+{
+    StatisticsResource upstream { pmr::new_delete_resource() };
+    const double time { measureBest([&]{
+        auto resource { makeResource(&upstream) };
+        buildAndDestroy<pmr::list<int>, pmr::map<pmr::string, int>>(n, resource.get());
+    }, 3) };
+    printRow(name, n, time * 1e3, upstream.allocations() / 3, upstream.peakBytes() / 1024);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 1'000'000) };
+
+    cout << "Build + destroy list<int> and map<string,int> (time in ms, upstream allocations per run, peak in KiB)" << endl;
+    printHeader({ "resource", "nodes", "time", "allocations", "peak KiB" });
+
+    for (auto n : decades(1000, maxSize)) {
+        // Reference: standard containers, global heap
+        const double time { measureBest([&]{
+            list<int> l;
+            for (size_t i { 0 }; i < n; i++)
+                l.push_back(static_cast<int>(i));
+            map<string, int> m;
+            for (size_t i { 0 }; i < n; i++)
+                m.emplace(to_string(i), static_cast<int>(i));
+            doNotOptimize(l.size() + m.size());
+        }, 3) };
+        printRow("std allocator", n, time * 1e3, "", "");
+
+        // Heap through pmr: one upstream allocation per node
+        run("new_delete", n, [](pmr::memory_resource* upstream) {
+            // Statistics resource forwards everything to its own upstream
+            return make_unique<StatisticsResource>(upstream);
+        });
+        run("monotonic", n, [](pmr::memory_resource* upstream) {
+            return make_unique<pmr::monotonic_buffer_resource>(upstream);
+        });
+        run("unsync pool", n, [](pmr::memory_resource* upstream) {
+            return make_unique<pmr::unsynchronized_pool_resource>(upstream);
+        });
+        run("sync pool", n, [](pmr::memory_resource* upstream) {
+            return make_unique<pmr::synchronized_pool_resource>(upstream);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "policyVector.h"
+
+using namespace std;
+
+
+/// Items added one by one: small enough for exact growth (quadratic) to finish
+constexpr size_t pushes { 4096 };
+
+/// ns per push_back, without reserve: growth and allocator at work
+template<typename Vector>
+double timePushBack()
+{
+    constexpr int rounds { 10 };
+    const double time { measureBest([] {
+        for (int round { 0 }; round < rounds; round++) {
+            Vector v;
+            for (size_t i { 0 }; i < pushes; i++)
+                v.push_back(static_cast<int>(i));
+            doNotOptimize(v.data());
+        }
+        // Arena memory is only freed as a whole, once the vectors using it are gone
+        ArenaAllocator::release();
+    }) };
+    return time / (rounds * pushes) * 1e9;
+}
+
+/// ns per item to sum the vector in order
+template<typename Vector>
+double timeIteration(const Vector& v)
+{
+    return measureBest([&] {
+        long total { 0 };
+        for (const int item : v)
+            total += item;
+        doNotOptimize(total);
+    }) / static_cast<double>(v.size()) * 1e9;
+}
+
+/// ns per access to sum items at random indexes (operator[]: bounds policy applies)
+template<typename Vector>
+double timeRandomAccess(const Vector& v, const vector<uint32_t>& indexes)
+{
+    return measureBest([&] {
+        long total { 0 };
+        for (const auto index : indexes)
+            total += v[index];
+        doNotOptimize(total);
+    }) / static_cast<double>(indexes.size()) * 1e9;
+}
+
+template<template<typename, typename> class Storage, typename Growth, typename Allocator>
+void run(const string& storage, const string& growth, const string& allocator, const vector<uint32_t>& indexes)
+{
+    using Unchecked = policy_vector<int, Storage, Growth, Allocator, NoBoundsCheck>;
+    using Checked = policy_vector<int, Storage, Growth, Allocator, BoundsChecked>;
+    const double pushBack { timePushBack<Unchecked>() };
+    double iteration, random, randomChecked;
+    {
+        // Built with resize: a single allocation of the final size, whatever the growth policy
+        Unchecked unchecked(indexes.size(), 1);
+        Checked checked(indexes.size(), 1);
+        iteration = timeIteration(unchecked);
+        random = timeRandomAccess(unchecked, indexes);
+        randomChecked = timeRandomAccess(checked, indexes);
+    }
+    ArenaAllocator::release();
+    printRow(storage, growth, allocator, pushBack, iteration, random, randomChecked);
+}
+
+template<template<typename, typename> class Storage, typename Allocator>
+void runGrowths(const string& storage, const string& allocator, const vector<uint32_t>& indexes)
+{
+    run<Storage, Growth1_5x, Allocator>(storage, "1.5x", allocator, indexes);
+    run<Storage, Growth2x, Allocator>(storage, "2x", allocator, indexes);
+    run<Storage, ExactGrowth, Allocator>(storage, "exact", allocator, indexes);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto size { maxSizeFromArgs(argc, argv, 4'000'000) };
+    mt19937 generator { 42 };
+    uniform_int_distribution<uint32_t> distribution { 0, static_cast<uint32_t>(size - 1) };
+    vector<uint32_t> indexes(size);
+    for (auto& index : indexes)
+        index = distribution(generator);
+
+    cout << "Policy combinations, ns per operation: push_back of " << pushes << " ints (no reserve),"
+         << " iteration and random access over " << size << " ints" << endl;
+    printHeader({ "storage", "growth", "allocator", "push_back", "iterate", "random", "random chk" });
+    runGrowths<HeapStorage, StdAllocator>("heap", "std", indexes);
+    runGrowths<HeapStorage, ArenaAllocator>("heap", "arena", indexes);
+    runGrowths<HeapStorage, HugePageAllocator>("heap", "huge page", indexes);
+    runGrowths<InlineStorage, StdAllocator>("inline", "std", indexes);
+    runGrowths<InlineStorage, ArenaAllocator>("inline", "arena", indexes);
+    runGrowths<InlineStorage, HugePageAllocator>("inline", "huge page", indexes);
+    // MmapStorage maps its pages itself: the allocator policy is not used
+    runGrowths<MmapStorage, StdAllocator>("mmap", "-", indexes);
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "lockFreeQueues.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+
+/// Items are send timestamps (ns), consumers compute end to end latency. -1 tells a consumer to stop.
+constexpr long stopItem { -1 };
+
+long timestamp()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/// Reference: deque protected by a mutex, consumers wait on a condition variable
+class LockedQueue
+{
+public:
+    void push(long item)
+    {
+        {
+            lock_guard lock { m_mutex };
+            m_items.push_back(item);
+        }
+        m_notEmpty.notify_one();
+    }
+
+    long pop()
+    {
+        unique_lock lock { m_mutex };
+        m_notEmpty.wait(lock, [this] { return !m_items.empty(); });
+        const long item { m_items.front() };
+        m_items.pop_front();
+        return item;
+    }
+
+private:
+    mutex m_mutex;
+    condition_variable m_notEmpty;
+    deque<long> m_items;
+};
+
+/// Pattern of postingFunc/waitingFunc carrying data: semaphore counts items, a mutex protects them
+class SemaphoreQueue
+{
+public:
+    void push(long item)
+    {
+        {
+            lock_guard lock { m_mutex };
+            m_items.push_back(item);
+        }
+        m_available.release();
+    }
+
+    long pop()
+    {
+        m_available.acquire();
+        lock_guard lock { m_mutex };
+        const long item { m_items.front() };
+        m_items.pop_front();
+        return item;
+    }
+
+private:
+    counting_semaphore<> m_available { 0 };
+    mutex m_mutex;
+    deque<long> m_items;
+};
+
+struct Result
+{
+    double seconds;
+    vector<double> latencies;   // microseconds
+};
+
+/// 'producers' threads push 'count' items in total, 'consumers' threads pop them one at a time
+template<typename Queue>
+Result transfer(Queue& queue, size_t count, unsigned producers, unsigned consumers)
+{
+    vector<vector<double>> latencies(consumers);
+    const auto start { Clock::now() };
+    vector<thread> threads;
+    for (unsigned c { 0 }; c < consumers; c++)
+        threads.emplace_back([&, c] {
+            latencies[c].reserve(count / consumers + 1);
+            for (long item { queue.pop() }; item != stopItem; item = queue.pop())
+                latencies[c].push_back(static_cast<double>(timestamp() - item) / 1e3);
+        });
+    vector<thread> producerThreads;
+    for (unsigned p { 0 }; p < producers; p++)
+        producerThreads.emplace_back([&, p] {
+            for (size_t i { p }; i < count; i += producers)
+                queue.push(timestamp());
+        });
+    for (auto& t : producerThreads)
+        t.join();
+    for (unsigned c { 0 }; c < consumers; c++)
+        queue.push(stopItem);
+    for (auto& t : threads)
+        t.join();
+
+    Result result { chrono::duration<double>(Clock::now() - start).count(), {} };
+    for (auto& l : latencies)
+        result.latencies.insert(result.latencies.end(), l.begin(), l.end());
+    return result;
+}
+
+/// One producer, one consumer, items moved by batches of 'batch'
+Result transferBatch(SpscQueue<long>& queue, size_t count, size_t batch)
+{
+    vector<double> latencies;
+    latencies.reserve(count);
+    const auto start { Clock::now() };
+    thread consumer { [&] {
+        vector<long> items(batch);
+        while (true) {
+            const auto popped { queue.pop_batch(items.begin(), batch) };
+            const long now { timestamp() };
+            for (size_t i { 0 }; i < popped; i++) {
+                if (items[i] == stopItem)
+                    return;
+                latencies.push_back(static_cast<double>(now - items[i]) / 1e3);
+            }
+        }
+    } };
+    vector<long> items(batch);
+    for (size_t i { 0 }; i < count; i += batch) {
+        const auto n { min(batch, count - i) };
+        const long now { timestamp() };
+        fill_n(items.begin(), n, now);
+        queue.push_batch(items.begin(), items.begin() + static_cast<ptrdiff_t>(n));
+    }
+    queue.push(stopItem);
+    consumer.join();
+    return { chrono::duration<double>(Clock::now() - start).count(), move(latencies) };
+}
+
+void printResult(const string& name, const string& threads, size_t count, Result result)
+{
+    auto& latencies { result.latencies };
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))]; };
+    printRow(name, threads, static_cast<double>(count) / result.seconds / 1e6, percentile(0.5), percentile(0.99));
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto count { maxSizeFromArgs(argc, argv, 1'000'000) };
+    constexpr size_t capacity { 1024 };
+
+    cout << "Transfer of " << count << " items: throughput and end to end latency" << endl;
+    printHeader({ "queue", "threads", "Mitems/s", "median (us)", "99% (us)" });
+
+    {
+        SemaphoreQueue queue;
+        printResult("semaphore", "1P1C", count, transfer(queue, count, 1, 1));
+    }
+    {
+        LockedQueue queue;
+        printResult("mutex+cv", "1P1C", count, transfer(queue, count, 1, 1));
+    }
+    {
+        SpscQueue<long> queue(capacity);
+        printResult("spsc", "1P1C", count, transfer(queue, count, 1, 1));
+    }
+    {
+        SpscQueue<long> queue(capacity);
+        printResult("spsc batch64", "1P1C", count, transferBatch(queue, count, 64));
+    }
+    {
+        MpmcQueue<long> queue(capacity);
+        printResult("mpmc", "1P1C", count, transfer(queue, count, 1, 1));
+    }
+    {
+        SemaphoreQueue queue;
+        printResult("semaphore", "2P2C", count, transfer(queue, count, 2, 2));
+    }
+    {
+        LockedQueue queue;
+        printResult("mutex+cv", "2P2C", count, transfer(queue, count, 2, 2));
+    }
+    {
+        MpmcQueue<long> queue(capacity);
+        printResult("mpmc", "2P2C", count, transfer(queue, count, 2, 2));
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "parallelReduce.h"
+
+using namespace std;
+
+
+template<typename BinaryOp>
+void benchOperation(const string& name, const vector<double>& data, size_t n, BinaryOp op, double init)
+{
+    const auto first { data.begin() };
+    const auto last { data.begin() + static_cast<ptrdiff_t>(n) };
+    const int repeat { n < 10'000'000 ? 5 : 2 };
+    auto throughput = [n](double seconds) { return static_cast<double>(n) / seconds / 1e6; };
+
+    const double serialTime { measureBest([&]{ doNotOptimize(serialReduce(first, last, init, op)); }, repeat) };
+    printRow(name, n, "serial", 1, throughput(serialTime), 1.0);
+
+    const double policyTime { measureBest([&]{ doNotOptimize(policyReduce(first, last, init, op)); }, repeat) };
+    printRow(name, n, "par_unseq", thread::hardware_concurrency(), throughput(policyTime), serialTime / policyTime);
+
+    for (auto threads : threadCounts()) {
+        const double time { measureBest([&]{ doNotOptimize(threadedReduce(first, last, init, op, threads)); }, repeat) };
+        printRow(name, n, "threads", threads, throughput(time), serialTime / time);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    // Values close to 1 so that products neither overflow nor vanish
+    vector<double> data(maxSize);
+    for (size_t i { 0 }; i < maxSize; i++)
+        data[i] = 1.0 + static_cast<double>(i % 1000) * 1e-9;
+
+    cout << "Reduction throughput (million items/s) and speedup over serial loop" << endl;
+    printHeader({ "operation", "items", "flavour", "threads", "Mitems/s", "speedup" });
+
+    for (auto n : decades(1000, maxSize)) {
+        benchOperation("sum", data, n, std::plus<>{}, 0.0);
+        benchOperation("product", data, n, std::multiplies<>{}, 1.0);
+        benchOperation("max", data, n, [](auto prev, auto item){ return max(prev, item); }, 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <deque>
+#include <iostream>
+#include <numeric>
+#include <queue>
+#include <string>
+
+#include "benchmark.h"
+#include "ringBuffer.h"
+
+using namespace std;
+
+
+constexpr size_t operations { 10'000'000 };
+
+/// FIFO in steady state: 'depth' items queued, then one push and one pop per operation
+template<typename Queue>
+void benchQueue(const string& name, size_t depth)
+{
+    const double time { measureBest([&]{
+        Queue q;
+        for (size_t i { 0 }; i < depth; i++)
+            q.push(static_cast<int>(i));
+        long total { 0 };
+        for (size_t i { 0 }; i < operations; i++) {
+            q.push(static_cast<int>(i));
+            total += q.front();
+            q.pop();
+        }
+        doNotOptimize(total);
+    }, 3) };
+    printRow(name, "push+pop", depth, static_cast<double>(operations) / time / 1e6);
+}
+
+/// Deque used from both ends, then iterated
+template<typename Deque>
+void benchDeque(const string& name, size_t n)
+{
+    Deque d;
+    const double pushTime { measureBest([&]{
+        d = Deque();
+        for (size_t i { 0 }; i < n; i++) {
+            if (i % 2)
+                d.push_back(static_cast<int>(i));
+            else
+                d.push_front(static_cast<int>(i));
+        }
+    }, 3) };
+    const double iterationTime { measureBest([&]{ doNotOptimize(accumulate(d.begin(), d.end(), 0L)); }) };
+    const double indexTime { measureBest([&]{
+        long total { 0 };
+        for (size_t i { 0 }; i < d.size(); i++)
+            total += d[i];
+        doNotOptimize(total);
+    }) };
+    printRow(name, "push ends", n, static_cast<double>(n) / pushTime / 1e6);
+    printRow(name, "iterate", n, static_cast<double>(n) / iterationTime / 1e6);
+    printRow(name, "index", n, static_cast<double>(n) / indexTime / 1e6);
+    if constexpr (requires { d.segments(); }) {
+        const double segmentsTime { measureBest([&]{
+            const auto [first, second] { d.segments() };
+            doNotOptimize(accumulate(second.begin(), second.end(), accumulate(first.begin(), first.end(), 0L)));
+        }) };
+        printRow(name, "segments", n, static_cast<double>(n) / segmentsTime / 1e6);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    cout << "Throughput in million operations (or items) per second" << endl;
+    printHeader({ "container", "operation", "items", "Mops/s" });
+
+    for (size_t depth : { 16, 1024, 65536 }) {
+        benchQueue<queue<int>>("queue<deque>", depth);
+        benchQueue<queue<int, ring_buffer<int>>>("queue<ring>", depth);
+    }
+    for (auto n : decades(1000, maxSize)) {
+        benchDeque<deque<int>>("deque", n);
+        benchDeque<ring_buffer<int>>("ring_buffer", n);
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <thread>
+
+#include "adaptiveSemaphore.h"
+#include "benchmark.h"
+
+using namespace std;
+
+
+/// Semaphore made of a mutex, a condition variable and a count
+class CondvarSemaphore
+{
+public:
+    void acquire()
+    {
+        unique_lock lock { m_mutex };
+        m_released.wait(lock, [this] { return m_count > 0; });
+        m_count--;
+    }
+
+    void release()
+    {
+        {
+            lock_guard lock { m_mutex };
+            m_count++;
+        }
+        m_released.notify_one();
+    }
+
+private:
+    mutex m_mutex;
+    condition_variable m_released;
+    ptrdiff_t m_count { 0 };
+};
+
+/// Ping-pong: 2 threads hand over a token through 2 semaphores, returns ns per round trip.
+/// The other thread does 'work' iterations of busy work before handing back: a short critical section
+template<typename Semaphore>
+double pingPong(Semaphore& ping, Semaphore& pong, size_t roundTrips, unsigned work)
+{
+    thread ponger { [&] {
+        for (size_t i { 0 }; i < roundTrips; i++) {
+            ping.acquire();
+            for (unsigned w { 0 }; w < work; w++)
+                doNotOptimize(w);
+            pong.release();
+        }
+    } };
+    const auto start { chrono::steady_clock::now() };
+    for (size_t i { 0 }; i < roundTrips; i++) {
+        ping.release();
+        pong.acquire();
+    }
+    const chrono::duration<double, nano> duration { chrono::steady_clock::now() - start };
+    ponger.join();
+    return duration.count() / static_cast<double>(roundTrips);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto roundTrips { maxSizeFromArgs(argc, argv, 100'000) };
+
+    cout << "Handoff latency: ns per round trip (2 handoffs), " << roundTrips << " round trips" << endl;
+    cout << "'work' is the number of busy loop iterations done by the other thread before handing back" << endl;
+    printHeader({ "semaphore", "work", "ns/trip", "fast", "slow" });
+
+    for (unsigned work : { 0u, 1000u }) {
+        {
+            counting_semaphore<> ping { 0 }, pong { 0 };
+            printRow("counting", work, pingPong(ping, pong, roundTrips, work), "-", "-");
+        }
+        {
+            CondvarSemaphore ping, pong;
+            printRow("condvar", work, pingPong(ping, pong, roundTrips, work), "-", "-");
+        }
+        {
+            AdaptiveSemaphore ping, pong;
+            const double time { pingPong(ping, pong, roundTrips, work) };
+            printRow("adaptive", work, time, ping.fastAcquires() + pong.fastAcquires(), ping.slowAcquires() + pong.slowAcquires());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "metaprogramming.h"
+#include "serialization.h"
+
+using namespace std;
+
+
+/// Text restore of what operator<< writes: "Size: n / Items: a b c "
+template<typename C>
+void readText(istream& is, C& container)
+{
+    string word;
+    size_t count;
+    is >> word >> count >> word >> word;
+    container.clear();
+    for (size_t i { 0 }; i < count; i++) {
+        typename C::value_type item;
+        is >> item;
+        container.insert(container.end(), item);
+    }
+}
+
+/// Text restore of what operator<< writes for maps: "Size: n / Items: k=v k=v "
+void readText(istream& is, map<string, int>& m)
+{
+    string word;
+    size_t count;
+    is >> word >> count >> word >> word;
+    m.clear();
+    for (size_t i { 0 }; i < count; i++) {
+        is >> word;
+        const auto separator { word.find('=') };
+        m.emplace_hint(m.end(), word.substr(0, separator), stoi(word.substr(separator + 1)));
+    }
+}
+
+/// Save + restore through text and through binary
+template<typename C>
+void compare(const string& name, const C& container)
+{
+    C restored;
+    const double textTime { measureBest([&]{
+        stringstream st;
+        st << setprecision(17) << container;
+        readText(st, restored);
+    }, 3) };
+    const double binaryTime { measureBest([&]{
+        stringstream st;
+        serialize(st, container);
+        deserialize(st, restored);
+    }, 3) };
+    if (restored != container)
+        cout << "ERROR: " << name << " not restored" << endl;
+    printRow(name, container.size(), textTime * 1e3, binaryTime * 1e3, textTime / binaryTime);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 1'000'000) };
+    const string path { "/tmp/benchSerialization.bin" };
+
+    cout << "Snapshot save + restore: text (operator<<) vs binary (times in ms)" << endl;
+    printHeader({ "container", "items", "text", "binary", "speedup" });
+
+    for (auto n : decades(1000, maxSize)) {
+        vector<double> vec(n);
+        list<int> l;
+        map<string, int> m;
+        for (size_t i { 0 }; i < n; i++) {
+            vec[i] = static_cast<double>(i) / 7.0;
+            l.push_back(static_cast<int>(i));
+            m.emplace("key" + to_string(i), static_cast<int>(i));
+        }
+        compare("vector<double>", vec);
+        compare("list<int>", l);
+        compare("map<str,int>", m);
+
+        // Restore through a memory mapped file: no copy at all
+        {
+            ofstream file(path, ios::binary);
+            serialize(file, vec);
+        }
+        const double viewTime { measureBest([&]{
+            MappedFile file(path);
+            auto view { binaryView<double>(file.data()) };
+            doNotOptimize(view.back());
+        }, 3) };
+        printRow("mmap view", n, "", viewTime * 1e3, "");
+    }
+    remove(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "simdKernels.h"
+
+using namespace std;
+
+
+template<typename F>
+void run(const string& type, const string& operation, const string& implementation, size_t n, F&& f)
+{
+    const double time { measureBest([&]{ doNotOptimize(f()); }) };
+    printRow(type, operation, implementation, n, static_cast<double>(n) / time / 1e6);
+}
+
+/// STL calls of containers.cpp vs SIMD kernels for each instruction set supported by the CPU
+template<typename T>
+void benchType(const string& type, size_t n)
+{
+    // Values close to 1 so that products neither overflow nor vanish
+    vector<T> data(n);
+    for (size_t i { 0 }; i < n; i++)
+        data[i] = std::is_floating_point<T>::value ? static_cast<T>(1.0 + static_cast<double>(i % 1000) * 1e-9) : static_cast<T>(i % 1000);
+    const T* d { data.data() };
+
+    run(type, "sum", "accumulate", n, [&]{ return accumulate(data.begin(), data.end(), T(0)); });
+    run(type, "sum", "reduce", n, [&]{ return reduce(data.begin(), data.end(), T(0)); });
+    run(type, "product", "accumulate", n, [&]{ return accumulate(data.begin(), data.end(), T(1), multiplies<>{}); });
+    run(type, "max", "reduce", n, [&]{ return reduce(data.begin(), data.end(), T(0), [](auto prev, auto item){return max(prev, item);}); });
+    run(type, "argmax", "max_element", n, [&]{ return max_element(data.begin(), data.end()) - data.begin(); });
+
+    for (auto level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (level > detectSimdLevel())
+            break;
+        const auto kernels { simdKernels<T>(level) };
+        run(type, "sum", toString(level), n, [&]{ return kernels.sum(d, n); });
+        run(type, "product", toString(level), n, [&]{ return kernels.product(d, n); });
+        run(type, "min", toString(level), n, [&]{ return kernels.min(d, n); });
+        run(type, "max", toString(level), n, [&]{ return kernels.max(d, n); });
+        run(type, "argmax", toString(level), n, [&]{ return kernels.argmax(d, n); });
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    cout << "CPU supports up to " << toString(detectSimdLevel()) << endl;
+    cout << "Throughput in million items/s" << endl;
+    printHeader({ "type", "operation", "version", "items", "Mitems/s" });
+
+    for (auto n : decades(1000, maxSize)) {
+        benchType<double>("double", n);
+        benchType<float>("float", n);
+        benchType<int32_t>("int32", n);
+        benchType<int64_t>("int64", n);
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <array>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "allocationCounter.h"
+#include "benchmark.h"
+#include "smallVector.h"
+
+using namespace std;
+
+
+constexpr int collections { 100'000 };
+
+/// Builds, reads and destroys 'collections' collections of 'size' items
+template<typename F>
+void run(const string& name, size_t size, F&& build)
+{
+    auto workload = [&] {
+        long total { 0 };
+        for (int i { 0 }; i < collections; i++)
+            total += build(i);
+        doNotOptimize(total);
+    };
+    const double time { measureBest(workload) };
+    const double allocations { static_cast<double>(countAllocations(workload)) / collections };
+    printRow(name, size, time / collections * 1e9, allocations);
+}
+
+
+int main()
+{
+    cout << "Build + sum + destroy a small collection of ints (ns and allocations per collection)" << endl;
+    printHeader({ "container", "items", "ns", "allocations" });
+
+    for (size_t size : { 1, 4, 8, 16, 32 }) {
+        run("vector", size, [size](int i) {
+            vector<int> v;
+            for (size_t k { 0 }; k < size; k++)
+                v.push_back(i + static_cast<int>(k));
+            return accumulate(v.begin(), v.end(), 0L);
+        });
+        run("vector+reserve", size, [size](int i) {
+            vector<int> v;
+            v.reserve(size);
+            for (size_t k { 0 }; k < size; k++)
+                v.push_back(i + static_cast<int>(k));
+            return accumulate(v.begin(), v.end(), 0L);
+        });
+        // Array has a fixed size: sized for the largest case, only 'size' items used
+        run("array<32>", size, [size](int i) {
+            array<int, 32> a;
+            for (size_t k { 0 }; k < size; k++)
+                a[k] = i + static_cast<int>(k);
+            return accumulate(a.begin(), a.begin() + static_cast<ptrdiff_t>(size), 0L);
+        });
+        run("small_vec<16>", size, [size](int i) {
+            small_vector<int, 16> v;
+            for (size_t k { 0 }; k < size; k++)
+                v.push_back(i + static_cast<int>(k));
+            return accumulate(v.begin(), v.end(), 0L);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "rangeSum.h"
+
+using namespace std;
+
+
+/// Prints ns per item and relative error against the exact sum
+template<typename T, typename F>
+void run(const string& type, const string& method, const vector<T>& values, long double exact, F&& f)
+{
+    T result {};
+    const double time { measureBest([&] {
+        result = f(values);
+        doNotOptimize(result);
+    }) };
+    const auto error { static_cast<double>(fabsl((static_cast<long double>(result) - exact) / exact)) };
+    printRow(type, method, values.size(), time / static_cast<double>(values.size()) * 1e9, error);
+}
+
+/// Random values in [0, 1), as the exact sum keeps growing: worst case for a running total
+template<typename T>
+void benchFloatingPoint(const string& type, size_t maxSize)
+{
+    mt19937 generator { 42 };
+    uniform_real_distribution<T> distribution { 0, 1 };
+    for (auto n : decades(1000, maxSize)) {
+        vector<T> values(n);
+        long double exact { 0 };
+        for (auto& value : values) {
+            value = distribution(generator);
+            exact += value;
+        }
+        run(type, "accumulate", values, exact, [](const auto& v) { return accumulate(v.begin(), v.end(), T { 0 }); });
+        run(type, "sum", values, exact, [](const auto& v) { return sum(v); });
+        run(type, "compensated", values, exact, [](const auto& v) { return sum(v, compensated); });
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxSize { maxSizeFromArgs(argc, argv, 10'000'000) };
+
+    cout << "Sum of random values in [0, 1): ns per item and relative error (long double reference)" << endl;
+    printHeader({ "type", "method", "items", "ns/item", "rel. error" });
+    benchFloatingPoint<float>("float", maxSize);
+    benchFloatingPoint<double>("double", maxSize);
+
+    cout << endl << "Concatenation of words of 1 to 16 characters: ns per word" << endl;
+    printHeader({ "method", "words", "ns/word" });
+    for (auto n : decades(1000, maxSize / 10)) {
+        vector<string> words(n);
+        for (size_t i { 0 }; i < n; i++)
+            words[i] = string(1 + i % 16, static_cast<char>('a' + i % 26));
+        auto timeOf = [&](auto f) { return measureBest([&] { doNotOptimize(f().size()); }) / static_cast<double>(n) * 1e9; };
+        printRow("accumulate", n, timeOf([&] { return accumulate(words.begin(), words.end(), string {}); }));
+        printRow("sum", n, timeOf([&] { return sum(words); }));
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "threadPool.h"
+
+using namespace std;
+
+
+/// Short job: a few hundred nanoseconds of computation
+long shortJob(long seed)
+{
+    long value { seed };
+    for (int i { 0 }; i < 100; i++)
+        value = value * 6364136223846793005L + 1442695040888963407L;
+    return value;
+}
+
+/// One job at a time: time from launch until its result is available
+template<typename Launch>
+void benchLatency(const string& name, size_t jobs, Launch launch)
+{
+    const double time { measureBest([&]{
+        long total { 0 };
+        for (size_t i { 0 }; i < jobs; i++)
+            total += launch(static_cast<long>(i));
+        doNotOptimize(total);
+    }, 3) };
+    printRow(name, "latency", jobs, time / static_cast<double>(jobs) * 1e6, static_cast<double>(jobs) / time / 1e3);
+}
+
+/// All jobs launched, then all results collected
+template<typename Launch, typename Collect>
+void benchThroughput(const string& name, size_t jobs, Launch launch, Collect collect)
+{
+    const double time { measureBest([&]{
+        for (size_t i { 0 }; i < jobs; i++)
+            launch(static_cast<long>(i));
+        doNotOptimize(collect());
+    }, 3) };
+    printRow(name, "throughput", jobs, time / static_cast<double>(jobs) * 1e6, static_cast<double>(jobs) / time / 1e3);
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto jobs { maxSizeFromArgs(argc, argv, 10'000) };
+    ThreadPool pool;
+
+    cout << "Running " << jobs << " short jobs (" << pool.size() << " workers in pool)" << endl;
+    printHeader({ "launcher", "mode", "jobs", "us/job", "Kjobs/s" });
+
+    benchLatency("thread", jobs, [](long seed) {
+        long result { 0 };
+        thread t { [&]{ result = shortJob(seed); } };
+        t.join();
+        return result;
+    });
+    benchLatency("async", jobs, [](long seed) { return async(launch::async, shortJob, seed).get(); });
+    benchLatency("pool", jobs, [&](long seed) { return pool.submit(shortJob, seed).get(); });
+
+    // Threads and async futures are only kept alive until collected: at most 'jobs' threads at once
+    vector<long> results(jobs);
+    vector<thread> threads;
+    threads.reserve(jobs);
+    benchThroughput("thread", jobs,
+        [&](long seed) { threads.emplace_back([&results, seed]{ results[static_cast<size_t>(seed)] = shortJob(seed); }); },
+        [&] {
+            for (auto& t : threads)
+                t.join();
+            threads.clear();
+            return results.back();
+        });
+
+    vector<future<long>> futures;
+    futures.reserve(jobs);
+    auto collectFutures = [&] {
+        long total { 0 };
+        for (auto& f : futures)
+            total += f.get();
+        futures.clear();
+        return total;
+    };
+    benchThroughput("async", jobs, [&](long seed) { futures.push_back(async(launch::async, shortJob, seed)); }, collectFutures);
+    benchThroughput("pool", jobs, [&](long seed) { futures.push_back(pool.submit(shortJob, seed)); }, collectFutures);
+
+    // parallelFor: no future per job, indexes grouped in chunks
+    const double time { measureBest([&]{
+        pool.parallelFor<size_t>(0, jobs, [&](size_t i) { results[i] = shortJob(static_cast<long>(i)); });
+        doNotOptimize(results.back());
+    }, 3) };
+    printRow("parallelFor", "throughput", jobs, time / static_cast<double>(jobs) * 1e6, static_cast<double>(jobs) / time / 1e3);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "timingWheel.h"
+
+using namespace std;
+using Clock = TimingWheel::Clock;
+
+
+/// Delays between 1s and 100s: no timer fires while measuring insertion and cancellation
+vector<chrono::microseconds> randomDelays(size_t n)
+{
+    mt19937 random { 42 };
+    uniform_int_distribution<long> delay { 1'000'000, 100'000'000 };
+    vector<chrono::microseconds> delays(n);
+    for (auto& d : delays)
+        d = chrono::microseconds(delay(random));
+    return delays;
+}
+
+/// Usual ordered timer queue: multimap by deadline, iterator used to cancel
+void benchMultimap(const vector<chrono::microseconds>& delays)
+{
+    multimap<Clock::time_point, function<void()>> timers;
+    vector<decltype(timers)::iterator> ids(delays.size());
+    const double insertTime { measureBest([&] {
+        timers.clear();
+        const auto now { Clock::now() };
+        for (size_t i { 0 }; i < delays.size(); i++)
+            ids[i] = timers.emplace(now + delays[i], [] {});
+    }, 1) };
+    const double cancelTime { measureBest([&] {
+        for (auto id : ids)
+            timers.erase(id);
+    }, 1) };
+    printRow("multimap", "insert", delays.size(), insertTime / static_cast<double>(delays.size()) * 1e9);
+    printRow("multimap", "cancel", delays.size(), cancelTime / static_cast<double>(delays.size()) * 1e9);
+}
+
+void benchWheel(const vector<chrono::microseconds>& delays)
+{
+    TimingWheel wheel;
+    vector<TimerId> ids(delays.size());
+    const double insertTime { measureBest([&] {
+        for (size_t i { 0 }; i < delays.size(); i++)
+            ids[i] = wheel.schedule(delays[i], [] {});
+    }, 1) };
+    const double cancelTime { measureBest([&] {
+        for (auto id : ids)
+            wheel.cancel(id);
+    }, 1) };
+    printRow("wheel", "insert", delays.size(), insertTime / static_cast<double>(delays.size()) * 1e9);
+    printRow("wheel", "cancel", delays.size(), cancelTime / static_cast<double>(delays.size()) * 1e9);
+}
+
+/// All timers due at the same time: how long until the last one has run
+void benchFire(size_t n)
+{
+    TimingWheel wheel;
+    atomic<size_t> fired { 0 };
+    const auto delay { 50ms };
+    const auto due { Clock::now() + delay };
+    for (size_t i { 0 }; i < n; i++)
+        wheel.schedule(delay, [&fired] { fired.fetch_add(1, memory_order_relaxed); });
+    while (fired.load() < n)
+        this_thread::sleep_for(100us);
+    const chrono::duration<double> firing { Clock::now() - due };
+    printRow("wheel", "fire", n, firing.count() / static_cast<double>(n) * 1e9);
+}
+
+/// Prints median, 99th percentile and max of the values (in microseconds)
+void printPercentiles(const string& name, vector<double> values)
+{
+    if (values.empty())
+        return;
+    sort(values.begin(), values.end());
+    auto percentile = [&](double p) { return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))]; };
+    printRow(name, values.size(), percentile(0.5), percentile(0.99), values.back());
+}
+
+/// 'n' periodic timers (period 1s) spread over the period: lateness of each firing compared to its schedule
+void benchJitter(size_t n, chrono::seconds duration)
+{
+    constexpr auto period { 1s };
+    vector<double> lateness(n * static_cast<size_t>(duration / period + 1));
+    atomic<size_t> count { 0 };
+    {
+        TimingWheel wheel;
+        for (size_t i { 0 }; i < n; i++) {
+            const auto offset { chrono::duration_cast<Clock::duration>(period) * static_cast<Clock::rep>(i) / static_cast<Clock::rep>(n) };
+            auto expected { make_shared<Clock::time_point>(Clock::now() + offset) };
+            wheel.schedulePeriodic(offset, period, [&, expected] {
+                const chrono::duration<double, micro> late { Clock::now() - *expected };
+                *expected += period;   // one firing at a time for a given timer: no race
+                const auto index { count.fetch_add(1, memory_order_relaxed) };
+                if (index < lateness.size())
+                    lateness[index] = late.count();
+            });
+        }
+        this_thread::sleep_for(duration);
+    }
+    lateness.resize(min(count.load(), lateness.size()));
+    printPercentiles("wheel", move(lateness));
+}
+
+/// Periodic job done with a sleep_for loop vs a periodic timer: delay of the last run compared to its schedule
+void benchDrift(int periods)
+{
+    constexpr auto period { 10ms };
+    auto work = [] { this_thread::sleep_for(1ms); };
+
+    const auto loopStart { Clock::now() };
+    for (int i { 0 }; i < periods; i++) {
+        work();
+        this_thread::sleep_for(period);
+    }
+    const chrono::duration<double, milli> loopDrift { Clock::now() - (loopStart + period * periods) };
+
+    TimingWheel wheel;
+    atomic<int> runs { 0 };
+    Clock::time_point lastRun;
+    atomic<bool> lastRunDone { false };   // published after lastRun is written
+    const auto wheelStart { Clock::now() };
+    const auto id { wheel.schedulePeriodic(period, period, [&] {
+        work();
+        if (runs.fetch_add(1) + 1 == periods) {
+            lastRun = Clock::now();
+            lastRunDone.store(true, memory_order_release);
+        }
+    }) };
+    while (!lastRunDone.load(memory_order_acquire))
+        this_thread::sleep_for(1ms);
+    wheel.cancel(id);
+    const chrono::duration<double, milli> wheelDrift { lastRun - (wheelStart + period * periods) };
+
+    printRow("sleep_for loop", periods, loopDrift.count());
+    printRow("wheel", periods, wheelDrift.count());
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto timers { maxSizeFromArgs(argc, argv, 100'000) };
+
+    cout << "Timer operations (ns per timer)" << endl;
+    printHeader({ "scheduler", "operation", "timers", "ns/timer" });
+    const auto delays { randomDelays(timers) };
+    benchMultimap(delays);
+    benchWheel(delays);
+    benchFire(timers);
+    cout << endl;
+
+    cout << "Firing lateness with " << timers << " active periodic timers (us)" << endl;
+    printHeader({ "scheduler", "firings", "median", "99%", "max" });
+    benchJitter(timers, 3s);
+    cout << endl;
+
+    cout << "Drift of a 10ms periodic job taking 1ms (ms late at last run)" << endl;
+    printHeader({ "scheduler", "runs", "drift (ms)" });
+    benchDrift(100);
+
+    return 0;
+}
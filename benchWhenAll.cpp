@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "benchmark.h"
+#include "coroutineTask.h"
+#include "futureCombinators.h"
+#include "timingWheel.h"
+
+using namespace std;
+using namespace std::chrono_literals;
+
+
+/// Delay of the i-th of n computations: the first one is the slowest (30ms), the last one the fastest (10ms)
+chrono::milliseconds delay(size_t i, size_t n)
+{
+    return 10ms + 20ms * static_cast<long>(n - 1 - i) / static_cast<long>(max<size_t>(n - 1, 1));
+}
+
+double millisecondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/// Starts n computations, the i-th one sets its promise after delay(i, n). Callbacks share the
+/// promises: they may still be inside set_value when the waiting thread is done with them.
+template<typename Promise, typename Future>
+vector<Future> fanOut(TimingWheel& timers, size_t n)
+{
+    auto promises { make_shared<vector<Promise>>(n) };
+    vector<Future> futures;
+    for (size_t i { 0 }; i < n; i++) {
+        futures.push_back((*promises)[i].get_future());
+        timers.schedule(delay(i, n), [promises, i] { (*promises)[i].set_value(static_cast<int>(i)); });
+    }
+    return futures;
+}
+
+/// Results read with get() one by one. Returns ms to get all results, and ms to get the first future of the list.
+pair<double, double> sequentialGet(TimingWheel& timers, size_t n)
+{
+    const auto start { chrono::steady_clock::now() };
+    auto futures { fanOut<promise<int>, future<int>>(timers, n) };
+    int sum { futures[0].get() };
+    const double first { millisecondsSince(start) };
+    for (size_t i { 1 }; i < n; i++)
+        sum += futures[i].get();
+    const double all { millisecondsSince(start) };
+    doNotOptimize(sum);
+    return { all, first };
+}
+
+task<int> sumAll(vector<AsyncFuture<int>> futures)
+{
+    int sum { 0 };
+    for (auto& future : co_await when_all(move(futures)))
+        sum += co_await future;
+    co_return sum;
+}
+
+task<int> firstValue(vector<AsyncFuture<int>> futures)
+{
+    auto result { co_await when_any(move(futures)) };
+    co_return co_await result.futures[result.index];
+}
+
+/// Same fan out with AsyncPromise and when_all / when_any, awaited from the calling thread with syncWait
+pair<double, double> combinators(TimingWheel& timers, CoroutineExecutor& executor, size_t n)
+{
+    auto start { chrono::steady_clock::now() };
+    doNotOptimize(executor.syncWait(sumAll(fanOut<AsyncPromise<int>, AsyncFuture<int>>(timers, n))));
+    const double all { millisecondsSince(start) };
+
+    start = chrono::steady_clock::now();
+    auto futures { fanOut<AsyncPromise<int>, AsyncFuture<int>>(timers, n) };
+    doNotOptimize(executor.syncWait(firstValue(futures)));
+    const double first { millisecondsSince(start) };
+    // Next measures shouldn't be delayed by the remaining timers
+    executor.syncWait(when_all(move(futures)));
+    return { all, first };
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto maxTasks { maxSizeFromArgs(argc, argv, 1000) };
+
+    cout << "Fan out of n computations ending after 30ms (first one) down to 10ms (last one)" << endl;
+    cout << "ms until all results (get all, when_all) and until a first result (get first, when_any)" << endl;
+    printHeader({ "tasks", "get all", "when_all", "get first", "when_any" });
+
+    TimingWheel timers;
+    CoroutineExecutor executor(1);
+    for (auto n : decades(1, maxTasks)) {
+        const auto [getAll, getFirst] { sequentialGet(timers, n) };
+        const auto [whenAll, whenAny] { combinators(timers, executor, n) };
+        printRow(n, getAll, whenAll, getFirst, whenAny);
+    }
+
+    return 0;
+}
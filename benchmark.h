@@ -0,0 +1,91 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*************************************
+ * Small helpers shared by the bench*.cpp executables.
+ * Each benchmark runs a piece of code several times and keeps the best duration,
+ * which is the least noisy figure on a busy machine.
+ * Largest size tested can be given as first command line argument so that
+ * huge runs (1e8, 1e9 items) are only done on purpose.
+ * **********************************/
+
+
+/// Prevents the compiler from optimizing away a value computed by a benchmark
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Runs 'f' 'repeat' times and returns the best duration in seconds
+template<typename F>
+double measureBest(F&& f, int repeat = 5)
+{
+    double best { std::numeric_limits<double>::max() };
+    for (int i { 0 }; i < repeat; i++) {
+        auto start { std::chrono::steady_clock::now() };
+        f();
+        std::chrono::duration<double> duration { std::chrono::steady_clock::now() - start };
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+/// Largest size to benchmark: first command line argument if any (accepts 1e7 notation), default otherwise
+inline std::size_t maxSizeFromArgs(int argc, char** argv, std::size_t defaultMax)
+{
+    if (argc > 1)
+        return static_cast<std::size_t>(std::strtod(argv[1], nullptr));
+    return defaultMax;
+}
+
+/// Sizes 'from', 10*from, 100*from... up to 'to' (included)
+inline std::vector<std::size_t> decades(std::size_t from, std::size_t to)
+{
+    std::vector<std::size_t> sizes;
+    for (std::size_t n { from }; n <= to; n *= 10)
+        sizes.push_back(n);
+    return sizes;
+}
+
+/// Thread counts to test: 1, 2, 4... up to the number of cores (included)
+inline std::vector<unsigned> threadCounts()
+{
+    const unsigned cores { std::max(1u, std::thread::hardware_concurrency()) };
+    std::vector<unsigned> counts;
+    for (unsigned n { 1 }; n < cores; n *= 2)
+        counts.push_back(n);
+    counts.push_back(cores);
+    return counts;
+}
+
+/// Prints a table header: each column is 14 characters wide
+inline void printHeader(const std::vector<std::string>& columns)
+{
+    for (const auto& column : columns)
+        std::cout << std::setw(14) << column;
+    std::cout << '\n' << std::string(14 * columns.size(), '-') << std::endl;
+}
+
+/// Prints one table row
+template<typename... Cells>
+void printRow(const Cells&... cells)
+{
+    ((std::cout << std::setw(14) << std::setprecision(4) << cells), ...);
+    std::cout << std::endl;
+}
+
+
+#endif // BENCHMARK_H
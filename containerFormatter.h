@@ -0,0 +1,225 @@
+#ifndef CONTAINERFORMATTER_H
+#define CONTAINERFORMATTER_H
+
+#include <charconv>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * FAST FORMATTING
+ * operator<< from metaprogramming.h pushes each item through std::ostream, one at a time.
+ * Each call goes through the locale, the stream state checks and the streambuf.
+ * This is fine for a handful of items but becomes the bottleneck for millions of them.
+ *
+ * BufferedWriter does the formatting itself:
+ * - numbers are written with std::to_chars (no locale, no allocation)
+ * - text is appended with a memcpy
+ * - everything goes to a char buffer that is reused and only written to the stream
+ *   when full, in large blocks.
+ * Output is the same as operator<< with the default stream flags: floating point
+ * values use the precision of the stream (%g style).
+ * **********************************/
+
+
+class BufferedWriter
+{
+public:
+    static constexpr std::size_t defaultCapacity { 64 * 1024 };
+
+    explicit BufferedWriter(std::ostream& os, std::size_t capacity = defaultCapacity)
+        : m_os(os), m_buffer(capacity < minCapacity ? minCapacity : capacity),
+          m_precision(static_cast<int>(os.precision()))
+    {}
+
+    /// Uses 'buffer' (its whole size) instead of allocating one: see takeBuffer()
+    BufferedWriter(std::ostream& os, std::vector<char>&& buffer)
+        : m_os(os), m_buffer(std::move(buffer)), m_precision(static_cast<int>(os.precision()))
+    {
+        if (m_buffer.size() < minCapacity)
+            m_buffer.resize(minCapacity);
+    }
+
+    // Remaining data is written when writer goes out of scope
+    ~BufferedWriter()
+    {
+        flush();
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /// Appends any printable value: number, text, container or anything with an operator<<
+    template<typename T>
+    BufferedWriter& operator<<(const T& value);
+
+    /// Writes buffered data to the stream
+    void flush()
+    {
+        if (m_size) {
+            m_os.write(m_buffer.data(), static_cast<std::streamsize>(m_size));
+            m_size = 0;
+        }
+    }
+
+    /// Flushes and gives the buffer back, to be reused by another writer. Nothing can be written afterwards.
+    std::vector<char> takeBuffer()
+    {
+        flush();
+        return std::move(m_buffer);
+    }
+
+    void put(char c)
+    {
+        if (m_size == m_buffer.size())
+            flush();
+        m_buffer[m_size++] = c;
+    }
+
+    void put(std::string_view text)
+    {
+        if (text.size() > m_buffer.size() - m_size) {
+            flush();
+            // Too large to be buffered: written directly
+            if (text.size() > m_buffer.size()) {
+                m_os.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        text.copy(m_buffer.data() + m_size, text.size());
+        m_size += text.size();
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type
+    putNumber(T value)
+    {
+        if (m_buffer.size() - m_size < maxNumberLength)
+            flush();
+        char* first { m_buffer.data() + m_size };
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point<T>::value)
+            result = std::to_chars(first, first + maxNumberLength, value, std::chars_format::general, m_precision);
+        else
+            result = std::to_chars(first, first + maxNumberLength, value);
+        if (result.ec != std::errc {}) {
+            // More digits than maxNumberLength (very high precision): formatted by a stream instead
+            std::ostringstream st;
+            st.precision(m_precision);
+            st << value;
+            put(st.view());
+            return;
+        }
+        m_size += static_cast<std::size_t>(result.ptr - first);
+    }
+
+private:
+    static constexpr std::size_t minCapacity { 256 };
+    // Longest number representation: long double with a precision set up to ~50 digits
+    static constexpr std::size_t maxNumberLength { 128 };
+
+    std::ostream& m_os;
+    std::vector<char> m_buffer;
+    std::size_t m_size { 0 };
+    int m_precision;
+};
+
+
+/**
+ * @brief Writes size and items of a container accepted by is_type_container.
+ * Same output as operator<<, but items are iterated by reference.
+ */
+template<typename T>
+typename std::enable_if<is_type_container<T>::value>::type
+formatContainer(BufferedWriter& out, const T& container)
+{
+    out << "Size: " << container.size() << " / Items: ";
+    for (const auto& item : container) {
+        out << item;
+        out.put(' ');
+    }
+}
+
+/**
+ * @brief Writes size and key=value items of a map. Pairs are not copied.
+ */
+template<typename T>
+typename std::enable_if<is_type_map<T>::value>::type
+formatContainer(BufferedWriter& out, const T& m)
+{
+    out << "Size: " << m.size() << " / Items: ";
+    for (const auto& [key, value] : m) {
+        out << key;
+        out.put('=');
+        out << value;
+        out.put(' ');
+    }
+}
+
+
+template<typename T>
+BufferedWriter& BufferedWriter::operator<<(const T& value)
+{
+    // Compile time dispatch: only the matching branch is compiled for each type
+    if constexpr (std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value)
+        put(static_cast<char>(value));
+    else if constexpr (std::is_same<T, bool>::value)
+        put(value ? '1' : '0');
+    else if constexpr (std::is_arithmetic<T>::value)
+        putNumber(value);
+    else if constexpr (std::is_convertible<const T&, std::string_view>::value)
+        put(std::string_view(value));
+    else if constexpr (is_type_container<T>::value || is_type_map<T>::value)
+        formatContainer(*this, value);
+    else if constexpr (is_type_adaptor<T>::value)
+        formatContainer(*this, adaptorView(value));
+    else {
+        // Unknown type: fall back to its own operator<<, after buffered data to keep ordering
+        flush();
+        m_os << value;
+    }
+    return *this;
+}
+
+
+/**
+ * Wrapper to use the writer straight from a stream:
+ *     cout << formatted(vec) << endl;
+ */
+template<typename T>
+struct Formatted {
+    const T& value;
+};
+
+template<typename T>
+Formatted<T> formatted(const T& value)
+{
+    return Formatted<T> { value };
+}
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, Formatted<T> f)
+{
+    // Buffer kept by the thread, allocated once. Moved out while in use: a nested call
+    // (operator<< of an item using formatted()) gets a buffer of its own.
+    thread_local std::vector<char> buffer;
+    if (buffer.empty())
+        buffer.resize(BufferedWriter::defaultCapacity);
+    BufferedWriter out(os, std::move(buffer));
+    out << f.value;
+    buffer = out.takeBuffer();
+    return os;
+}
+
+
+#endif // CONTAINERFORMATTER_H
@@ -7,11 +7,20 @@
 #include <deque>
 #include <set>
 #include <map>
+#include <string>
 #include <iterator>
 #include <numeric>
 #include <algorithm>
+#include <execution>
 
 #include "metaprogramming.h"
+#include "containerFormatter.h"
+#include "join.h"
+#include "flatMap.h"
+#include "openHashMap.h"
+#include "smallVector.h"
+#include "memoryResources.h"
+#include "ringBuffer.h"
 
 
 
@@ -52,6 +61,17 @@ int main()
     l.erase(l.begin());     // Remove list item
     cout << l << endl;
 
+    // Each node of a list is a separate allocation. With a pmr list, nodes are taken from a
+    // memory resource, here an arena: large blocks, all freed at once (see memoryResources.h).
+    {
+        StatisticsResource heap;
+        pmr::monotonic_buffer_resource arena { &heap };
+        pmr::list<int> pl { &arena };
+        for (int i { 0 }; i < 100; i++)
+            pl.push_back(i);
+        cout << "pmr list of " << pl.size() << " nodes -> heap " << heap << endl;
+    }
+
     //############################################################
 
     cout << endl << "-> array" << endl << endl;
@@ -65,6 +85,20 @@ int main()
     ar.fill(2);
     cout << ar << endl;
 
+    // small_vector is in between (see smallVector.h): up to N items are stored inside the object
+    // as in an array, items move to the heap only if it grows beyond N. Same interface as vector.
+    small_vector<int, 4> sv { 1, 2, 3 };
+    cout << sv << "-> stored inline: " << sv.is_inline() << endl;
+    sv.push_back(4);
+    sv.push_back(5);
+    cout << sv << "-> stored inline: " << sv.is_inline() << endl;
+    // As with vector, the value given to resize or assign may be one of the items
+    small_vector<string, 2> words { "one", "two", "three" };
+    words.resize(8, words[0]);
+    cout << words << endl;
+    words.assign(3, words[1]);
+    cout << words << endl;
+
     //############################################################
 
     cout << endl << "-> stack" << endl << endl;
@@ -75,6 +109,7 @@ int main()
     st.push(3);
     st.push(5);
     cout << "Pushed 2 items. Size is now " << st.size() << endl;
+    cout << "Stack can be printed from top to bottom without being modified: " << st << endl;
     cout << "Top item is " << st.top() << " but item still in place. Size is still " << st.size() << endl;
     st.pop();
     cout << "Pop the first item, size is now " << st.size() << endl;
@@ -92,6 +127,12 @@ int main()
     q.pop();
     cout << q << endl;
 
+    // Priority queue: top item is always the greatest one. Printed in internal (heap) order.
+    priority_queue<int> pq;
+    for (int item : {3, 1, 4, 1, 5})
+        pq.push(item);
+    cout << "Priority queue, top is " << pq.top() << ": " << pq << endl;
+
     //############################################################
 
     cout << endl << "-> deque" << endl << endl;
@@ -105,6 +146,15 @@ int main()
     dq.insert(dq.end()-3, 7);       // Insert before 3rd position starting from the end
     cout << dq << endl;
 
+    // Same operations on a ring buffer (see ringBuffer.h): a single array used as a circle
+    // instead of blocks. It can also be used under a queue: queue<float, ring_buffer<float>>
+    ring_buffer<int> rb(5, 3);
+    rb.push_front(1);
+    rb.push_back(9);
+    rb.insert(rb.begin()+2, 4);
+    rb.insert(rb.end()-3, 7);
+    cout << rb << endl;
+
     //############################################################
 
     cout << endl << "-> set" << endl << endl;
@@ -136,6 +186,15 @@ int main()
     cout << "Counting occurences of a given key:" << endl;
     cout << m.count("baz") << endl;
 
+    // Same interface, but items stored in contiguous memory (see flatMap.h and openHashMap.h):
+    // - flat_map: sorted vector, searched by dichotomy
+    // - open_hash_map: hash table without nodes
+    // Both compare "foo" directly with the keys, without building a temporary string.
+    flat_map<string, int> fm { {"foo", 3}, {"bar", 5} };
+    open_hash_map<string, int> hm { {"foo", 3}, {"bar", 5} };
+    cout << fm << " -> foo=" << fm.find("foo")->second << endl;
+    cout << hm << " -> baz count=" << hm.count("baz") << endl;
+
 
     //############################################################
     cout << endl << "Operations on container" << endl;
@@ -159,6 +218,10 @@ int main()
     cout << "same but with different implem:" << endl;
     cout << "-> " << accumulate(vec.begin()+1, vec.end(), std::to_string(vec.front()),
                 [](const auto previous, const auto item){return previous + " " + std::to_string(item);}) << endl;
+    cout << "Both build a new string at each step and copy everything built so far (quadratic)." << endl;
+    cout << "To build a line from a large container, join writes everything in a single string:" << endl;
+    cout << "-> " << join(vec) << endl;
+    cout << "-> " << join(m, ",", [](const auto& item){return item.first;}) << endl;
 
     //############################################################
     cout << endl << "Reduce (only since C++17)" << endl;
@@ -167,6 +230,9 @@ int main()
     cout << "- Initial value and return type of operation shall be of same type as iterable" << endl;
     cout << "- Operation can be executed in any order" << endl;
     cout << "-> " << reduce(vec.begin(), vec.end()) << endl;
+    cout << "Since order doesn't matter, work can be split over several threads with an execution policy" << endl;
+    cout << "(see parallelReduce.h and benchReduce for large containers):" << endl;
+    cout << "-> " << reduce(execution::par_unseq, vec.begin(), vec.end()) << endl;
 
     cout << endl << "Can be customized with any operation, provided, return value is the same type" << endl;
     cout << "Example to search max value in a container:" << endl;
@@ -216,5 +282,13 @@ int main()
         cout << "Item not found";
 
 
+    //############################################################
+    cout << endl << "Fast formatting" << endl;
+    cout << "---------------" << endl;
+    cout << "operator<< sends each item through the stream. For large containers, formatted() writes" << endl;
+    cout << "items into a buffer with to_chars and sends it to the stream in large blocks. Same output:" << endl;
+    cout << formatted(vec) << endl;
+    cout << formatted(m) << endl;
+
     return 0;
 }
@@ -0,0 +1,475 @@
+#ifndef COROUTINETASK_H
+#define COROUTINETASK_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+/*************************************
+ * COROUTINES (C++20)
+ * future.get() blocks the whole thread until the value is available: a thousand pending
+ * waits need a thousand threads, each with its own stack and a kernel context switch to
+ * wake up.
+ * A coroutine is a function that can suspend itself (co_await) and be resumed later.
+ * While it is suspended, its state is kept in a heap allocated frame and the thread is
+ * free to run something else. Resuming is a function call, not a context switch.
+ *
+ * - task<T>: coroutine returning a T (co_return value). It is lazy: it only starts when
+ *   awaited (co_await task), and when it ends, the awaiting coroutine is resumed directly
+ *   by the thread that ran the end of the task.
+ *   An exception thrown by the task is rethrown by co_await, as future.get() does.
+ * - CoroutineExecutor: a few threads resuming coroutines. co_await executor.schedule()
+ *   moves a coroutine to these threads, co_await executor.sleepFor(100ms) suspends it
+ *   without blocking any thread. spawn() starts a task in background, syncWait() starts a
+ *   task and blocks the calling thread until its result is available (from main, for instance).
+ * - AsyncPromise<T> / AsyncFuture<T>: same as std::promise / std::future, but the future is
+ *   awaited (co_await) instead of blocking. A promise destroyed before being fulfilled gives
+ *   a std::future_error (broken_promise) to the awaiting coroutine. Several coroutines may
+ *   wait for the same future (copies share the state), the value is moved to the first one
+ *   resuming: others should only wait (see futureCombinators.h).
+ *
+ * The compiler doesn't check lifetime: arguments taken by reference must outlive the task.
+ * **********************************/
+
+
+template<typename T = void>
+class task;
+
+namespace detail {
+
+/// Storage of the result of a coroutine: value or exception
+template<typename T>
+class TaskResult
+{
+public:
+    void return_value(T value) { m_result.template emplace<1>(std::move(value)); }
+    void unhandled_exception() { m_result.template emplace<2>(std::current_exception()); }
+
+    T result()
+    {
+        if (m_result.index() == 2)
+            std::rethrow_exception(std::get<2>(m_result));
+        return std::move(std::get<1>(m_result));
+    }
+
+private:
+    std::variant<std::monostate, T, std::exception_ptr> m_result;
+};
+
+template<>
+class TaskResult<void>
+{
+public:
+    void return_void() {}
+    void unhandled_exception() { m_exception = std::current_exception(); }
+
+    void result()
+    {
+        if (m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+private:
+    std::exception_ptr m_exception;
+};
+
+/// Coroutine started and forgotten: its frame is freed when it ends
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        // Same as an exception escaping a std::thread
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+} // namespace detail
+
+
+template<typename T>
+class task
+{
+public:
+    struct promise_type : detail::TaskResult<T>
+    {
+        task get_return_object() { return task { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        // Lazy: the body only starts when the task is awaited
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            /// Resumes the awaiting coroutine, unless it is still inside co_await (task ended without suspending)
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                auto& promise { handle.promise() };
+                if (promise.finished.exchange(true, std::memory_order_acq_rel) && promise.continuation)
+                    return promise.continuation;
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        std::coroutine_handle<> continuation;
+        // Set by the first of: the task ending, the awaiting coroutine being suspended.
+        // The second one knows who goes on.
+        std::atomic<bool> finished { false };
+    };
+
+    task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    task& operator=(task other) noexcept
+    {
+        std::swap(m_handle, other.m_handle);
+        return *this;
+    }
+
+    ~task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    /// co_await task: starts the task, resumes when it ends, returns its result or rethrows its exception
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() noexcept { return false; }
+            /**
+             * Runs the task until it ends or suspends. Returns false (go on without suspending)
+             * if it ended: a loop awaiting tasks that end immediately doesn't pile up stack frames,
+             * even when the compiler doesn't turn resumption into a tail call (GCC without optimizations).
+             */
+            bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                auto& promise { handle.promise() };
+                promise.continuation = awaiting;
+                handle.resume();
+                return !promise.finished.exchange(true, std::memory_order_acq_rel);
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter { m_handle };
+    }
+
+    auto operator co_await() & noexcept
+    {
+        return std::move(*this).operator co_await();
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+
+class CoroutineExecutor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CoroutineExecutor(unsigned threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned i { 0 }; i < threadCount; i++)
+            m_threads.emplace_back(&CoroutineExecutor::runLoop, this);
+        m_timerThread = std::thread(&CoroutineExecutor::timerLoop, this);
+    }
+
+    CoroutineExecutor(const CoroutineExecutor&) = delete;
+    CoroutineExecutor& operator=(const CoroutineExecutor&) = delete;
+
+    /// Coroutines still sleeping or waiting are not resumed any more: wait for tasks first (syncWait)
+    ~CoroutineExecutor()
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_stop = true;
+        }
+        m_readyChanged.notify_all();
+        m_timersChanged.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+        m_timerThread.join();
+    }
+
+    /// Queues the coroutine to be resumed by one of the executor threads
+    void post(std::coroutine_handle<> handle)
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_ready.push_back(handle);
+        }
+        m_readyChanged.notify_one();
+    }
+
+    /// co_await executor.schedule(): continues on an executor thread
+    auto schedule()
+    {
+        struct Awaiter
+        {
+            CoroutineExecutor& executor;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() noexcept {}
+        };
+        return Awaiter { *this };
+    }
+
+    /// co_await executor.sleepUntil(time): suspends the coroutine, no thread is blocked meanwhile
+    auto sleepUntil(Clock::time_point deadline)
+    {
+        struct Awaiter
+        {
+            CoroutineExecutor& executor;
+            Clock::time_point deadline;
+            bool await_ready() noexcept { return deadline <= Clock::now(); }
+            void await_suspend(std::coroutine_handle<> handle) { executor.addTimer(deadline, handle); }
+            void await_resume() noexcept {}
+        };
+        return Awaiter { *this, deadline };
+    }
+
+    template<typename Rep, typename Period>
+    auto sleepFor(std::chrono::duration<Rep, Period> delay)
+    {
+        return sleepUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay));
+    }
+
+    /// Runs the task in background on the executor. An exception escaping the task terminates the program.
+    template<typename T>
+    void spawn(task<T> t)
+    {
+        post(runDetached(std::move(t)).handle);
+    }
+
+    /// Runs the task on the executor and blocks the calling thread until it ends
+    template<typename T>
+    T syncWait(task<T> t)
+    {
+        std::promise<T> promise;
+        auto future { promise.get_future() };
+        post(fulfill(std::move(t), std::move(promise)).handle);
+        return future.get();
+    }
+
+private:
+    template<typename T>
+    static detail::DetachedTask runDetached(task<T> t)
+    {
+        co_await t;
+    }
+
+    template<typename T>
+    static detail::DetachedTask fulfill(task<T> t, std::promise<T> promise)
+    {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await t;
+                promise.set_value();
+            }
+            else
+                promise.set_value(co_await t);
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> handle)
+    {
+        bool earliest;
+        {
+            std::lock_guard lock { m_mutex };
+            m_timers.push({ deadline, handle });
+            earliest = m_timers.top().handle == handle;
+        }
+        if (earliest)
+            m_timersChanged.notify_one();
+    }
+
+    void runLoop()
+    {
+        std::unique_lock lock { m_mutex };
+        while (true) {
+            m_readyChanged.wait(lock, [this] { return m_stop || !m_ready.empty(); });
+            if (m_stop)
+                return;
+            auto handle { m_ready.front() };
+            m_ready.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+    }
+
+    /// Sleeping coroutines are queued by deadline, a single thread posts them when their time is reached
+    void timerLoop()
+    {
+        std::unique_lock lock { m_mutex };
+        while (!m_stop) {
+            if (m_timers.empty()) {
+                m_timersChanged.wait(lock);
+                continue;
+            }
+            const auto deadline { m_timers.top().deadline };
+            if (Clock::now() < deadline) {
+                m_timersChanged.wait_until(lock, deadline);
+                continue;
+            }
+            bool posted { false };
+            while (!m_timers.empty() && m_timers.top().deadline <= Clock::now()) {
+                m_ready.push_back(m_timers.top().handle);
+                m_timers.pop();
+                posted = true;
+            }
+            if (posted)
+                m_readyChanged.notify_all();
+        }
+    }
+
+    struct Timer
+    {
+        Clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer& other) const { return deadline > other.deadline; }
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_readyChanged;
+    std::condition_variable m_timersChanged;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_timers;
+    bool m_stop { false };
+    std::vector<std::thread> m_threads;
+    std::thread m_timerThread;
+};
+
+
+template<typename T>
+class AsyncFuture;
+
+/// Producer side: set_value or set_exception, once. The awaiting coroutine is resumed by the thread fulfilling the promise.
+template<typename T>
+class AsyncPromise
+{
+public:
+    AsyncPromise() : m_state(std::make_shared<State>()) {}
+    AsyncPromise(AsyncPromise&&) noexcept = default;
+    AsyncPromise& operator=(AsyncPromise&&) noexcept = default;
+
+    ~AsyncPromise()
+    {
+        if (m_state && !m_state->ready)
+            set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+
+    AsyncFuture<T> get_future() { return AsyncFuture<T> { m_state }; }
+
+    template<typename... Value>
+    void set_value(Value&&... value)
+    {
+        fulfill([&](auto& result) { result.template emplace<1>(std::forward<Value>(value)...); });
+    }
+
+    void set_exception(std::exception_ptr exception)
+    {
+        fulfill([&](auto& result) { result.template emplace<2>(std::move(exception)); });
+    }
+
+private:
+    friend class AsyncFuture<T>;
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    struct State
+    {
+        std::mutex mutex;
+        bool ready { false };
+        std::variant<std::monostate, Value, std::exception_ptr> result;
+        std::vector<std::coroutine_handle<>> waiting;
+    };
+
+    template<typename Set>
+    void fulfill(Set set)
+    {
+        std::vector<std::coroutine_handle<>> waiting;
+        {
+            std::lock_guard lock { m_state->mutex };
+            if (m_state->ready)
+                throw std::future_error(std::future_errc::promise_already_satisfied);
+            set(m_state->result);
+            m_state->ready = true;
+            waiting.swap(m_state->waiting);
+        }
+        for (auto handle : waiting)
+            handle.resume();
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+/// Consumer side: co_await future returns the value or rethrows the exception
+template<typename T>
+class AsyncFuture
+{
+public:
+    /// True once the promise is fulfilled (value, exception or broken)
+    bool is_ready() const
+    {
+        std::lock_guard lock { m_state->mutex };
+        return m_state->ready;
+    }
+
+    bool await_ready() noexcept { return is_ready(); }
+
+    /// Returns false (no suspension) if the value arrived meanwhile
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        std::lock_guard lock { m_state->mutex };
+        if (m_state->ready)
+            return false;
+        m_state->waiting.push_back(handle);
+        return true;
+    }
+
+    T await_resume()
+    {
+        if (m_state->result.index() == 2)
+            std::rethrow_exception(std::get<2>(m_state->result));
+        if constexpr (!std::is_void_v<T>)
+            return std::move(std::get<1>(m_state->result));
+    }
+
+private:
+    friend class AsyncPromise<T>;
+    explicit AsyncFuture(std::shared_ptr<typename AsyncPromise<T>::State> state) : m_state(std::move(state)) {}
+
+    std::shared_ptr<typename AsyncPromise<T>::State> m_state;
+};
+
+
+#endif // COROUTINETASK_H
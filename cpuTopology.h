@@ -0,0 +1,262 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+/*************************************
+ * CPU TOPOLOGY AND THREAD PLACEMENT
+ * The scheduler may move a thread to another core at any time: its caches are cold there.
+ * On machines with several sockets, memory is split in NUMA nodes: each socket reaches its
+ * own memory faster than the memory of another socket (remote access goes through the
+ * interconnect, with higher latency and lower bandwidth).
+ *
+ * CpuTopology::detect() reads the layout from sysfs (Linux): for each logical CPU this process
+ * may run on, its physical core, its package (socket) and its NUMA node. Logical CPUs of
+ * the same core are hyperthreads: they share the core's execution units and caches.
+ * place(workers, policy) gives a CPU for each worker:
+ * - Compact: fill a core (all its hyperthreads), then the next core of the same node.
+ *   Workers share caches: fits threads working on the same data.
+ * - Scatter: spread workers over nodes, then over cores, hyperthreads last. Uses all memory
+ *   controllers and caches: fits memory bound work on separate data.
+ * - PhysicalCores: one worker per physical core, in compact order (no hyperthread sharing).
+ * pinThread() binds a thread to a CPU (pthread_setaffinity_np).
+ *
+ * LOCAL MEMORY
+ * Linux puts a memory page on the node of the thread that touches it first, not of the
+ * thread that allocated it. allocateLocal() value-initializes the array from the calling
+ * thread: called from a pinned worker, the memory is on the worker's node. Data initialized
+ * by main and then processed by workers stays on main's node.
+ *
+ * Without sysfs (restricted containers), all CPUs are reported as separate cores of a single
+ * node: placement policies can't tell hyperthreads or nodes apart, pinning still works. On
+ * systems other than Linux, pinning does nothing (returns false).
+ * **********************************/
+
+
+struct LogicalCpu
+{
+    unsigned id { 0 };
+    unsigned core { 0 };      // physical core id, unique within a package
+    unsigned package { 0 };
+    unsigned node { 0 };
+};
+
+
+enum class Placement
+{
+    Compact,
+    Scatter,
+    PhysicalCores
+};
+
+
+class CpuTopology
+{
+public:
+    /// Reads the layout of the CPUs this process is allowed to run on
+    static CpuTopology detect()
+    {
+        CpuTopology topology;
+        const std::filesystem::path cpuRoot { "/sys/devices/system/cpu" };
+        const auto allowed { allowedCpus() };
+        std::map<unsigned, unsigned> nodeOfCpu;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+            const auto name { entry.path().filename().string() };
+            if (name.rfind("node", 0) != 0 || name.size() == 4 || name.find_first_not_of("0123456789", 4) != std::string::npos)
+                continue;
+            for (auto cpu : parseList(readLine(entry.path() / "cpulist")))
+                nodeOfCpu[cpu] = static_cast<unsigned>(std::stoul(name.substr(4)));
+        }
+
+        for (auto id : parseList(readLine(cpuRoot / "online"))) {
+            if (!allowed.empty() && !allowed.count(id))
+                continue;
+            const auto topologyDir { cpuRoot / ("cpu" + std::to_string(id)) / "topology" };
+            LogicalCpu cpu { id, readUnsigned(topologyDir / "core_id", id), readUnsigned(topologyDir / "physical_package_id", 0), 0 };
+            if (auto node { nodeOfCpu.find(id) }; node != nodeOfCpu.end())
+                cpu.node = node->second;
+            topology.m_cpus.push_back(cpu);
+        }
+
+        if (topology.m_cpus.empty())
+            for (unsigned id { 0 }; id < std::max(1u, std::thread::hardware_concurrency()); id++)
+                topology.m_cpus.push_back({ id, id, 0, 0 });
+        // Compact order: hyperthreads of a core together, cores of a node together
+        std::sort(topology.m_cpus.begin(), topology.m_cpus.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.node, a.package, a.core, a.id) < std::tie(b.node, b.package, b.core, b.id);
+        });
+        return topology;
+    }
+
+    /// Logical CPUs in compact order
+    const std::vector<LogicalCpu>& cpus() const { return m_cpus; }
+
+    unsigned nodeCount() const { return countDistinct([](const auto& cpu) { return std::make_pair(cpu.node, 0u); }); }
+    unsigned physicalCoreCount() const { return countDistinct([](const auto& cpu) { return std::make_pair(cpu.package, cpu.core); }); }
+
+    /// CPU id of each worker. With more workers than CPUs (or cores), CPUs are reused in the same order.
+    std::vector<unsigned> place(unsigned workers, Placement policy) const
+    {
+        std::vector<LogicalCpu> order;
+        std::vector<LogicalCpu> firstThreads;    // first hyperthread of each core
+        std::vector<LogicalCpu> otherThreads;
+        for (std::size_t i { 0 }; i < m_cpus.size(); i++) {
+            const bool sameCore { i > 0 && m_cpus[i].package == m_cpus[i - 1].package && m_cpus[i].core == m_cpus[i - 1].core };
+            (sameCore ? otherThreads : firstThreads).push_back(m_cpus[i]);
+        }
+
+        switch (policy) {
+        case Placement::Compact:
+            order = m_cpus;
+            break;
+        case Placement::Scatter:
+            order = interleaveNodes(firstThreads);
+            for (const auto& cpu : interleaveNodes(otherThreads))
+                order.push_back(cpu);
+            break;
+        case Placement::PhysicalCores:
+            order = firstThreads;
+            break;
+        }
+
+        std::vector<unsigned> placement;
+        for (unsigned worker { 0 }; worker < workers; worker++)
+            placement.push_back(order[worker % order.size()].id);
+        return placement;
+    }
+
+private:
+    template<typename Key>
+    unsigned countDistinct(Key key) const
+    {
+        std::set<std::pair<unsigned, unsigned>> keys;
+        for (const auto& cpu : m_cpus)
+            keys.insert(key(cpu));
+        return static_cast<unsigned>(keys.size());
+    }
+
+    /// First CPU of each node, then second CPU of each node...
+    static std::vector<LogicalCpu> interleaveNodes(const std::vector<LogicalCpu>& cpus)
+    {
+        std::map<unsigned, std::vector<LogicalCpu>> byNode;
+        for (const auto& cpu : cpus)
+            byNode[cpu.node].push_back(cpu);
+        std::vector<LogicalCpu> order;
+        for (std::size_t rank { 0 }; order.size() < cpus.size(); rank++)
+            for (const auto& [node, nodeCpus] : byNode)
+                if (rank < nodeCpus.size())
+                    order.push_back(nodeCpus[rank]);
+        return order;
+    }
+
+    static std::string readLine(const std::filesystem::path& path)
+    {
+        std::ifstream file { path };
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static unsigned readUnsigned(const std::filesystem::path& path, unsigned defaultValue)
+    {
+        const auto line { readLine(path) };
+        try {
+            return line.empty() ? defaultValue : static_cast<unsigned>(std::stoul(line));
+        } catch (const std::exception&) {
+            return defaultValue;
+        }
+    }
+
+    /// "0-3,8,10-11" -> 0 1 2 3 8 10 11
+    static std::vector<unsigned> parseList(const std::string& list)
+    {
+        std::vector<unsigned> values;
+        std::istringstream ranges { list };
+        for (std::string range; std::getline(ranges, range, ',');) {
+            if (range.empty() || range.find_first_not_of("0123456789-") != std::string::npos)
+                continue;
+            const auto dash { range.find('-') };
+            const auto first { static_cast<unsigned>(std::stoul(range.substr(0, dash))) };
+            const auto last { dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1))) };
+            for (auto value { first }; value <= last; value++)
+                values.push_back(value);
+        }
+        return values;
+    }
+
+    /// CPUs of the affinity mask of the process (taskset, cgroups), empty if unknown
+    static std::set<unsigned> allowedCpus()
+    {
+        std::set<unsigned> cpus;
+#ifdef __linux__
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+            for (unsigned cpu { 0 }; cpu < CPU_SETSIZE; cpu++)
+                if (CPU_ISSET(cpu, &mask))
+                    cpus.insert(cpu);
+#endif
+        return cpus;
+    }
+
+    std::vector<LogicalCpu> m_cpus;
+};
+
+
+/// Binds a thread to a logical CPU. Returns false if it failed or isn't supported.
+inline bool pinThread(std::thread::native_handle_type thread, unsigned cpu)
+{
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return pthread_setaffinity_np(thread, sizeof(mask), &mask) == 0;
+#else
+    (void)thread;
+    (void)cpu;
+    return false;
+#endif
+}
+
+inline bool pinThread(std::thread& thread, unsigned cpu) { return pinThread(thread.native_handle(), cpu); }
+
+inline bool pinCurrentThread(unsigned cpu)
+{
+#ifdef __linux__
+    return pinThread(pthread_self(), cpu);
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/// Array of 'size' value-initialized items, touched first by the calling thread: on its NUMA node
+template<typename T>
+std::unique_ptr<T[]> allocateLocal(std::size_t size)
+{
+    return std::make_unique<T[]>(size);
+}
+
+
+#endif // CPUTOPOLOGY_H
@@ -0,0 +1,403 @@
+#ifndef FIXEDVECTOR_H
+#define FIXEDVECTOR_H
+
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+
+/*************************************
+ * FIXED SIZE NUMERIC VECTOR (EXPRESSION TEMPLATES)
+ * With operators returning a new vector, r = a * b + c computes a * b in a temporary vector
+ * (one loop, one write of N items), then adds c in a second one (another loop, another pass
+ * over memory), then copies the result.
+ *
+ * Here, a * b + c doesn't compute anything: it returns an 'expression' object describing
+ * the computation. It is evaluated when assigned to a FixedVector, or reduced by dot/norm:
+ * a single loop, each item of a, b, c read once, no temporary.
+ * - elementwise +, -, *, scaling by a value (x * v, v * x), fma(a, b, c)
+ * - dot(x, y), norm(x): x and y may be expressions too (dot(a + b, c) is one loop)
+ *
+ * SIMD
+ * Items are processed one SIMD register at a time (GCC/clang vector extensions), register
+ * size chosen at compile time from the target: 16 bytes (SSE2, NEON), 32 (AVX), 64 (AVX-512).
+ * Storage is aligned on a register and padded to a whole number of registers: no scalar
+ * loop for the last items, padding items are computed as the others. They don't always
+ * stay 0 (0 * inf is NaN): reductions mask them in the last register. Vectors fitting one
+ * register (4 floats or 2 doubles with SSE2) are specialized at compile time: no loop at all, each operation is one instruction.
+ * Reductions keep several registers in flight on longer vectors to hide addition latency:
+ * floating point items are added in a different order than a plain loop.
+ *
+ * fma(a, b, c) computes a * b + c with a single rounding (std::fma) when the target has FMA
+ * instructions (FP_FAST_FMA), as a * b + c otherwise.
+ *
+ * IMPORTANT
+ * Expressions refer to the vectors they use: evaluate them before these are destroyed.
+ * Store results in a FixedVector, not in 'auto' (auto keeps the expression).
+ * **********************************/
+
+
+template<typename T, std::size_t N>
+    requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+class FixedVector;
+
+
+namespace vector_detail {
+
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__AVX512F__)
+inline constexpr std::size_t registerBytes { 64 };
+#elif defined(__AVX__)
+inline constexpr std::size_t registerBytes { 32 };
+#else
+inline constexpr std::size_t registerBytes { 16 };
+#endif
+
+template<typename T>
+struct PacketOf
+{
+    typedef T type __attribute__((vector_size(registerBytes)));
+};
+#else
+// No vector extensions: a packet is a single item
+inline constexpr std::size_t registerBytes { 0 };
+
+template<typename T>
+struct PacketOf
+{
+    using type = T;
+};
+#endif
+
+/// Items processed at once
+template<typename T>
+using Packet = typename PacketOf<T>::type;
+
+template<typename T>
+inline constexpr std::size_t lanes { sizeof(Packet<T>) / sizeof(T) };
+
+/// Items stored: N rounded up to a whole number of packets
+template<typename T, std::size_t N>
+inline constexpr std::size_t paddedSize { (N + lanes<T> - 1) / lanes<T> * lanes<T> };
+
+template<typename T>
+inline constexpr bool hasFastFma {
+#ifdef FP_FAST_FMA
+    std::is_same_v<T, double> ||
+#endif
+#ifdef FP_FAST_FMAF
+    std::is_same_v<T, float> ||
+#endif
+    false
+};
+
+template<typename T>
+struct IsFixedVector : std::false_type {};
+
+template<typename T, std::size_t N>
+struct IsFixedVector<FixedVector<T, N>> : std::true_type {};
+
+/// Vectors are kept by reference in expressions, expressions (small objects) by value
+template<typename E>
+using Operand = std::conditional_t<IsFixedVector<E>::value, const E&, E>;
+
+struct Plus {
+    template<typename P> P operator()(const P& a, const P& b) const { return a + b; }
+};
+struct Minus {
+    template<typename P> P operator()(const P& a, const P& b) const { return a - b; }
+};
+struct Multiplies {
+    template<typename P> P operator()(const P& a, const P& b) const { return a * b; }
+};
+
+/// Padding lanes of the last packet set to 0, whatever operations gave for them
+template<typename T, std::size_t N>
+Packet<T> maskPadding(Packet<T> packet)
+{
+    if constexpr (paddedSize<T, N> != N)
+        for (std::size_t lane { N % lanes<T> }; lane < lanes<T>; lane++)
+            packet[lane] = 0;
+    return packet;
+}
+
+template<typename T>
+T horizontalSum(const Packet<T>& packet)
+{
+    if constexpr (std::is_same_v<Packet<T>, T>)
+        return packet;
+    else {
+        T total { 0 };
+        for (std::size_t lane { 0 }; lane < lanes<T>; lane++)
+            total += packet[lane];
+        return total;
+    }
+}
+
+} // namespace vector_detail
+
+
+/// FixedVector or expression combining them: gives a packet of values at any packet index
+template<typename E>
+concept VectorExpression = std::remove_cvref_t<E>::isVectorExpression;
+
+/// Expressions of the same item type and size
+template<typename L, typename R>
+concept CompatibleVectors = VectorExpression<L> && VectorExpression<R>
+                            && std::is_same_v<typename std::remove_cvref_t<L>::value_type, typename std::remove_cvref_t<R>::value_type>
+                            && std::remove_cvref_t<L>::extent == std::remove_cvref_t<R>::extent;
+
+
+template<typename T, std::size_t N>
+    requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+class FixedVector
+{
+public:
+    using value_type = T;
+    using Packet = vector_detail::Packet<T>;
+    static constexpr bool isVectorExpression { true };
+    static constexpr std::size_t extent { N };
+    static constexpr std::size_t packets { vector_detail::paddedSize<T, N> / vector_detail::lanes<T> };
+    /// True if the whole vector is a single SIMD register
+    static constexpr bool singleRegister { packets == 1 && !std::is_same_v<Packet, T> };
+
+    /// All items zero
+    FixedVector() = default;
+
+    /// All items set to 'value'
+    explicit FixedVector(T value)
+    {
+        for (std::size_t i { 0 }; i < N; i++)
+            m_values[i] = value;
+    }
+
+    /// One value per item
+    template<std::convertible_to<T>... U>
+        requires(sizeof...(U) == N && N > 1)
+    FixedVector(U... values) : m_values { static_cast<T>(values)... }
+    {}
+
+    /// Evaluates an expression
+    template<typename E>
+        requires(!std::is_same_v<E, FixedVector> && CompatibleVectors<FixedVector, E>)
+    FixedVector(const E& expression)
+    {
+        assign(expression);
+    }
+
+    template<typename E>
+        requires(!std::is_same_v<E, FixedVector> && CompatibleVectors<FixedVector, E>)
+    FixedVector& operator=(const E& expression)
+    {
+        assign(expression);
+        return *this;
+    }
+
+    static constexpr std::size_t size() { return N; }
+
+    T& operator[](std::size_t i) { return m_values[i]; }
+    const T& operator[](std::size_t i) const { return m_values[i]; }
+
+    T* begin() { return m_values; }
+    T* end() { return m_values + N; }
+    const T* begin() const { return m_values; }
+    const T* end() const { return m_values + N; }
+    const T* data() const { return m_values; }
+
+    /// Packet of items starting at item index * lanes
+    Packet packet(std::size_t index) const
+    {
+        Packet packet;
+        std::memcpy(&packet, m_values + index * vector_detail::lanes<T>, sizeof(Packet));
+        return packet;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const FixedVector& vector)
+    {
+        out << '(';
+        for (std::size_t i { 0 }; i < N; i++)
+            out << (i ? ", " : "") << vector.m_values[i];
+        return out << ')';
+    }
+
+private:
+    template<typename E>
+    void assign(const E& expression)
+    {
+        // Items of an expression only depend on the items of the same index: evaluating
+        // packet by packet is correct even if this vector is used in the expression
+        if constexpr (singleRegister)
+            store(0, expression.packet(0));
+        else
+            for (std::size_t index { 0 }; index < packets; index++)
+                store(index, expression.packet(index));
+    }
+
+    void store(std::size_t index, const Packet& packet)
+    {
+        std::memcpy(m_values + index * vector_detail::lanes<T>, &packet, sizeof(Packet));
+    }
+
+    alignas(sizeof(Packet)) T m_values[vector_detail::paddedSize<T, N>] {};
+};
+
+
+/// Base of expression nodes: item type and size of the operands
+template<typename E>
+struct VectorNode
+{
+    using value_type = typename std::remove_cvref_t<E>::value_type;
+    using Packet = vector_detail::Packet<value_type>;
+    static constexpr bool isVectorExpression { true };
+    static constexpr std::size_t extent { std::remove_cvref_t<E>::extent };
+    static constexpr std::size_t packets { std::remove_cvref_t<E>::packets };
+};
+
+template<typename Op, typename L, typename R>
+class Elementwise : public VectorNode<L>
+{
+public:
+    Elementwise(const L& left, const R& right) : m_left(left), m_right(right) {}
+
+    typename VectorNode<L>::Packet packet(std::size_t index) const { return Op {}(m_left.packet(index), m_right.packet(index)); }
+
+private:
+    vector_detail::Operand<L> m_left;
+    vector_detail::Operand<R> m_right;
+};
+
+template<typename E>
+class Scaled : public VectorNode<E>
+{
+public:
+    using value_type = typename VectorNode<E>::value_type;
+
+    Scaled(const E& expression, value_type factor) : m_expression(expression), m_factor(factor) {}
+
+    typename VectorNode<E>::Packet packet(std::size_t index) const { return m_expression.packet(index) * m_factor; }
+
+private:
+    vector_detail::Operand<E> m_expression;
+    value_type m_factor;
+};
+
+template<typename A, typename B, typename C>
+class Fused : public VectorNode<A>
+{
+public:
+    using value_type = typename VectorNode<A>::value_type;
+    using Packet = typename VectorNode<A>::Packet;
+
+    Fused(const A& a, const B& b, const C& c) : m_a(a), m_b(b), m_c(c) {}
+
+    Packet packet(std::size_t index) const
+    {
+        const Packet a { m_a.packet(index) };
+        const Packet b { m_b.packet(index) };
+        const Packet c { m_c.packet(index) };
+        if constexpr (vector_detail::hasFastFma<value_type> && !std::is_same_v<Packet, value_type>) {
+            Packet result;
+            for (std::size_t lane { 0 }; lane < vector_detail::lanes<value_type>; lane++)
+                result[lane] = std::fma(a[lane], b[lane], c[lane]);
+            return result;
+        }
+        else if constexpr (vector_detail::hasFastFma<value_type>)
+            return std::fma(a, b, c);
+        else
+            return a * b + c;
+    }
+
+private:
+    vector_detail::Operand<A> m_a;
+    vector_detail::Operand<B> m_b;
+    vector_detail::Operand<C> m_c;
+};
+
+
+template<typename L, typename R>
+    requires CompatibleVectors<L, R>
+Elementwise<vector_detail::Plus, L, R> operator+(const L& left, const R& right)
+{
+    return { left, right };
+}
+
+template<typename L, typename R>
+    requires CompatibleVectors<L, R>
+Elementwise<vector_detail::Minus, L, R> operator-(const L& left, const R& right)
+{
+    return { left, right };
+}
+
+template<typename L, typename R>
+    requires CompatibleVectors<L, R>
+Elementwise<vector_detail::Multiplies, L, R> operator*(const L& left, const R& right)
+{
+    return { left, right };
+}
+
+template<VectorExpression E>
+Scaled<E> operator*(const E& expression, typename E::value_type factor)
+{
+    return { expression, factor };
+}
+
+template<VectorExpression E>
+Scaled<E> operator*(typename E::value_type factor, const E& expression)
+{
+    return { expression, factor };
+}
+
+/// a * b + c, with a single rounding when the target has FMA instructions
+template<typename A, typename B, typename C>
+    requires CompatibleVectors<A, B> && CompatibleVectors<A, C>
+Fused<A, B, C> fma(const A& a, const B& b, const C& c)
+{
+    return { a, b, c };
+}
+
+/// Sum of the products of the items
+template<typename L, typename R>
+    requires CompatibleVectors<L, R>
+auto dot(const L& left, const R& right)
+{
+    using T = typename L::value_type;
+    using Packet = vector_detail::Packet<T>;
+    constexpr std::size_t packets { L::packets };
+    constexpr std::size_t unroll { 4 };
+    // Last packet added apart, without its padding
+    constexpr std::size_t whole { packets - 1 };
+    const Packet last { vector_detail::maskPadding<T, L::extent>(left.packet(whole) * right.packet(whole)) };
+
+    if constexpr (packets < unroll) {
+        Packet total { last };
+        for (std::size_t index { 0 }; index < whole; index++)
+            total += left.packet(index) * right.packet(index);
+        return vector_detail::horizontalSum<T>(total);
+    }
+    else {
+        // Independent accumulators: an addition doesn't wait for the previous one
+        Packet totals[unroll] {};
+        std::size_t index { 0 };
+        for (; index + unroll <= whole; index += unroll)
+            for (std::size_t k { 0 }; k < unroll; k++)
+                totals[k] += left.packet(index + k) * right.packet(index + k);
+        if constexpr (whole % unroll != 0)
+            for (; index < whole; index++)
+                totals[0] += left.packet(index) * right.packet(index);
+        totals[unroll - 1] += last;
+        return vector_detail::horizontalSum<T>((totals[0] + totals[1]) + (totals[2] + totals[3]));
+    }
+}
+
+/// Euclidean norm
+template<VectorExpression E>
+auto norm(const E& expression)
+{
+    return std::sqrt(dot(expression, expression));
+}
+
+
+#endif // FIXEDVECTOR_H
@@ -0,0 +1,171 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * FLAT MAP
+ * std::map stores each item in its own node (red-black tree): each step of a lookup
+ * follows a pointer to a node that is probably not in cache.
+ * flat_map keeps items sorted in a single vector and searches them by dichotomy.
+ * + lookups and iteration only read contiguous memory
+ * + no memory overhead, a single allocation
+ * - inserting or erasing an item shifts all the following ones (O(n)): best suited
+ *   to maps built once (or in order) and read many times
+ * - iterators are invalidated by insertions and erasures, as with vectors
+ *
+ * Default comparator is std::less<> (transparent): find("foo") or find(string_view)
+ * compare directly with the keys, no temporary std::string is built.
+ * Keys must not be modified through iterators (that would break the order).
+ * **********************************/
+
+
+template<typename K, typename V, typename Compare = std::less<>>
+class flat_map
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    flat_map() = default;
+
+    flat_map(std::initializer_list<value_type> items)
+    {
+        for (const auto& item : items)
+            insert(item);
+    }
+
+    iterator begin() { return m_items.begin(); }
+    iterator end() { return m_items.end(); }
+    const_iterator begin() const { return m_items.begin(); }
+    const_iterator end() const { return m_items.end(); }
+
+    size_type size() const { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+    void clear() { m_items.clear(); }
+    void reserve(size_type n) { m_items.reserve(n); }
+
+    template<typename Key>
+    iterator find(const Key& key)
+    {
+        auto it { lowerBound(key) };
+        return (it != m_items.end() && !m_compare(key, it->first)) ? it : m_items.end();
+    }
+
+    template<typename Key>
+    const_iterator find(const Key& key) const
+    {
+        return const_cast<flat_map*>(this)->find(key);
+    }
+
+    template<typename Key>
+    size_type count(const Key& key) const { return find(key) != end(); }
+
+    template<typename Key>
+    bool contains(const Key& key) const { return find(key) != end(); }
+
+    template<typename Key>
+    V& at(const Key& key)
+    {
+        auto it { find(key) };
+        if (it == end())
+            throw std::out_of_range("flat_map::at: key not found");
+        return it->second;
+    }
+
+    template<typename Key>
+    const V& at(const Key& key) const
+    {
+        return const_cast<flat_map*>(this)->at(key);
+    }
+
+    /// Inserts the item if key is not found. Returns the item and whether it was inserted.
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        auto it { lowerBound(key) };
+        if (it != m_items.end() && !m_compare(key, it->first))
+            return { it, false };
+        it = m_items.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        return { it, true };
+    }
+
+    template<typename Key, typename Value>
+    std::pair<iterator, bool> emplace(Key&& key, Value&& value)
+    {
+        return try_emplace(std::forward<Key>(key), std::forward<Value>(value));
+    }
+
+    /// Items given in order are appended without any search
+    template<typename Key, typename Value>
+    iterator emplace_hint(const_iterator hint, Key&& key, Value&& value)
+    {
+        if (hint == m_items.cend() && (m_items.empty() || m_compare(m_items.back().first, key))) {
+            m_items.emplace_back(std::forward<Key>(key), std::forward<Value>(value));
+            return std::prev(m_items.end());
+        }
+        return emplace(std::forward<Key>(key), std::forward<Value>(value)).first;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& item)
+    {
+        return try_emplace(item.first, item.second);
+    }
+
+    template<typename Key>
+    V& operator[](Key&& key)
+    {
+        return try_emplace(std::forward<Key>(key)).first->second;
+    }
+
+    /// Iterators go to erase(const_iterator), as with std::map
+    template<typename Key>
+        requires(!std::is_convertible_v<const Key&, const_iterator>)
+    size_type erase(const Key& key)
+    {
+        auto it { find(key) };
+        if (it == end())
+            return 0;
+        m_items.erase(it);
+        return 1;
+    }
+
+    iterator erase(const_iterator it) { return m_items.erase(it); }
+
+    bool operator==(const flat_map& other) const { return m_items == other.m_items; }
+
+private:
+    template<typename Key>
+    iterator lowerBound(const Key& key)
+    {
+        return std::lower_bound(m_items.begin(), m_items.end(), key,
+                                [this](const value_type& item, const Key& k) { return m_compare(item.first, k); });
+    }
+
+    std::vector<value_type> m_items;
+    [[no_unique_address]] Compare m_compare;
+};
+
+
+// enable operator<< (key=value)
+template<typename K, typename V, typename C>
+struct is_type_map<flat_map<K, V, C>> {
+  static const bool value = true;
+};
+
+
+#endif // FLATMAP_H
@@ -0,0 +1,101 @@
+#ifndef FUTURECOMBINATORS_H
+#define FUTURECOMBINATORS_H
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "coroutineTask.h"
+
+
+/*************************************
+ * WHEN_ALL / WHEN_ANY
+ * Waiting for several futures one after the other with get() blocks a thread per wait, and
+ * gives no way to react to the first result: get() on the first future waits for it even if
+ * all the others are ready.
+ *
+ * when_all(futures) and when_any(futures) are tasks (see coroutineTask.h) that wait on a set
+ * of AsyncFuture without any thread: the coroutine is suspended and resumed by the thread
+ * fulfilling the promise (the last one for when_all, the first one for when_any).
+ * - they don't take the values: they return the futures, all ready (when_all) or with the
+ *   index of the first ready one (when_any). Each future keeps its own result: a value, an
+ *   exception or a broken promise error, rethrown when the element is awaited.
+ * - when_any returns as soon as one future is ready. It watches the others with a small
+ *   coroutine each (a heap frame, not a thread), which ends when its future is fulfilled.
+ *   A promise never fulfilled nor destroyed keeps its watcher alive.
+ * - as std::experimental::when_any, an empty set gives index npos at once.
+ * **********************************/
+
+
+namespace detail {
+
+/// Waits until the future is ready, without taking its value
+template<typename T>
+struct ReadyAwaiter
+{
+    AsyncFuture<T>& future;
+
+    bool await_ready() { return future.await_ready(); }
+    bool await_suspend(std::coroutine_handle<> handle) { return future.await_suspend(handle); }
+    void await_resume() noexcept {}
+};
+
+struct WhenAnyState
+{
+    std::atomic<bool> done { false };
+    AsyncPromise<std::size_t> first;   // index of the first ready future
+};
+
+/// Watcher of one future for when_any: the first one to see its future ready gives its index
+template<typename T>
+DetachedTask signalWhenReady(AsyncFuture<T> future, std::shared_ptr<WhenAnyState> state, std::size_t index)
+{
+    co_await ReadyAwaiter<T> { future };
+    if (!state->done.exchange(true, std::memory_order_acq_rel))
+        state->first.set_value(index);
+}
+
+} // namespace detail
+
+
+template<typename T>
+struct WhenAnyResult
+{
+    static constexpr std::size_t npos { static_cast<std::size_t>(-1) };
+
+    std::size_t index;   // first ready future, npos if there was none
+    std::vector<AsyncFuture<T>> futures;
+};
+
+
+/// Resumes when all futures are ready, returns them
+template<typename T>
+task<std::vector<AsyncFuture<T>>> when_all(std::vector<AsyncFuture<T>> futures)
+{
+    // Waiting for each one in turn: the coroutine is only resumed when the current one is ready
+    for (auto& future : futures)
+        co_await detail::ReadyAwaiter<T> { future };
+    co_return std::move(futures);
+}
+
+/// Resumes as soon as one future is ready, returns its index and all futures
+template<typename T>
+task<WhenAnyResult<T>> when_any(std::vector<AsyncFuture<T>> futures)
+{
+    if (futures.empty())
+        co_return WhenAnyResult<T> { WhenAnyResult<T>::npos, {} };
+
+    auto state { std::make_shared<detail::WhenAnyState>() };
+    auto first { state->first.get_future() };
+    for (std::size_t i { 0 }; i < futures.size() && !state->done.load(std::memory_order_acquire); i++)
+        detail::signalWhenReady(futures[i], state, i).handle.resume();
+
+    const auto index { co_await first };
+    co_return WhenAnyResult<T> { index, std::move(futures) };
+}
+
+
+#endif // FUTURECOMBINATORS_H
@@ -0,0 +1,348 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perThread.h"
+#include "sharedCounters.h"
+
+
+/*************************************
+ * LATENCY INSTRUMENTATION
+ * Timing by hand (now() before, now() after, print milliseconds) gives one value per run:
+ * no idea of the spread, and printing on the hot path costs more than what is measured.
+ * What matters for latency is the distribution: median (p50) and tail (p99, p999, max).
+ *
+ * HDR HISTOGRAM (High Dynamic Range)
+ * Keeping every sample to sort them is too expensive. A histogram with buckets of equal
+ * width either is too coarse for small values or needs too many buckets for large ones.
+ * HdrHistogram buckets are log-linear: values below 256 have one bucket each, above that
+ * each power of two [2^k, 2^(k+1)) is split in 128 buckets. Relative error is below 1/128
+ * (< 0.8%) from 1ns to centuries, with a fixed array of 7424 counts. Recording is a bit
+ * scan, a shift and an increment.
+ *
+ * PER-THREAD RECORDING
+ * LatencyHistogram gives each thread its own counts (a 'shard'), created at its first
+ * record: threads never write the same memory, nothing is locked. Counts are atomics only
+ * so that snapshot() may read them while they are written. The owner thread updates them
+ * with a relaxed load and store (no read-modify-write, no lock prefix: as cheap as a plain
+ * increment). snapshot() merges all shards in a plain HdrHistogram; it is not an exact
+ * snapshot of a given instant, samples recorded meanwhile may or may not be counted.
+ * When a thread exits, its shard (~59KB) is retired: its counts are merged into the
+ * histogram and the shard is freed (see perThread.h).
+ *
+ * - ScopedTimer records the time spent in a scope (steady_clock, nanoseconds) when it
+ *   is destroyed. Recording costs a few ns, the 2 clock reads usually cost more (~20ns
+ *   each with a TSC based clock, far more in some virtual machines).
+ * - Instrumentation is a registry of named histograms and counters (ShardedCounter), with
+ *   text and JSON export. Names are looked up once (keep the reference), not per sample.
+ * **********************************/
+
+
+/// Log-linear histogram of non negative integer values (plain, not thread safe)
+class HdrHistogram
+{
+public:
+    static constexpr unsigned subBucketBits { 7 };
+    static constexpr std::uint64_t subBucketCount { 1 << subBucketBits };
+    static constexpr std::size_t bucketCount { (64 - subBucketBits + 1) * subBucketCount };
+
+    /// Index of the bucket holding 'value'
+    static constexpr std::size_t bucketIndex(std::uint64_t value)
+    {
+        const auto width { static_cast<unsigned>(std::bit_width(value)) };
+        if (width <= subBucketBits + 1)
+            return static_cast<std::size_t>(value);
+        // Keeps the 8 highest bits: mantissa in [128, 256)
+        const unsigned shift { width - subBucketBits - 1 };
+        return static_cast<std::size_t>(shift * subBucketCount + (value >> shift));
+    }
+
+    /// Highest value stored in a given bucket
+    static constexpr std::uint64_t highestValue(std::size_t index)
+    {
+        if (index < 2 * subBucketCount)
+            return index;
+        const auto shift { static_cast<unsigned>(index / subBucketCount - 1) };
+        const std::uint64_t mantissa { index % subBucketCount + subBucketCount };
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    HdrHistogram() : m_counts(bucketCount, 0) {}
+
+    void record(std::uint64_t value, std::uint64_t count = 1)
+    {
+        m_counts[bucketIndex(value)] += count;
+        m_count += count;
+        m_sum += value * count;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    void merge(const HdrHistogram& other)
+    {
+        for (std::size_t i { 0 }; i < bucketCount; i++)
+            m_counts[i] += other.m_counts[i];
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    std::uint64_t count() const { return m_count; }
+    std::uint64_t min() const { return m_count ? m_min : 0; }
+    std::uint64_t max() const { return m_max; }
+    double mean() const { return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0; }
+
+    /// Smallest value such that 'percent'% of samples are lower or equal (within bucket precision)
+    std::uint64_t percentile(double percent) const
+    {
+        if (m_count == 0)
+            return 0;
+        // Rank computed with integers: 99.9 / 100.0 * 1000 is slightly above 999 in floating point
+        constexpr std::uint64_t million { 1'000'000 };
+        const auto ppm { static_cast<std::uint64_t>(std::llround(std::clamp(percent, 0.0, 100.0) * 10'000)) };
+        const auto rank { std::max<std::uint64_t>(1, m_count / million * ppm + (m_count % million * ppm + million - 1) / million) };
+        std::uint64_t seen { 0 };
+        for (std::size_t i { 0 }; i < bucketCount; i++) {
+            seen += m_counts[i];
+            if (seen >= rank)
+                return std::min(highestValue(i), m_max);
+        }
+        return m_max;
+    }
+
+private:
+    friend class LatencyHistogram;
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_count { 0 };
+    std::uint64_t m_sum { 0 };
+    std::uint64_t m_min { UINT64_MAX };
+    std::uint64_t m_max { 0 };
+};
+
+
+/// Histogram recorded by several threads, each into its own shard, merged on demand
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t value) { threadShard().record(value); }
+
+    /// Sum of all shards
+    HdrHistogram snapshot() const
+    {
+        std::lock_guard lock { m_mutex };
+        mergeRetired();
+        HdrHistogram total { m_retired };
+        for (const auto& shard : m_shards)
+            shard->value.addTo(total);
+        return total;
+    }
+
+private:
+    /// Written by a single thread, read by snapshot()
+    class Shard
+    {
+    public:
+        void record(std::uint64_t value)
+        {
+            increment(m_counts[HdrHistogram::bucketIndex(value)], 1);
+            increment(m_sum, value);
+            if (value < m_min.load(std::memory_order_relaxed))
+                m_min.store(value, std::memory_order_relaxed);
+            if (value > m_max.load(std::memory_order_relaxed))
+                m_max.store(value, std::memory_order_relaxed);
+        }
+
+        void addTo(HdrHistogram& total) const
+        {
+            // Count from buckets: consistent with percentiles even if a record is in progress
+            std::uint64_t count { 0 };
+            for (std::size_t i { 0 }; i < HdrHistogram::bucketCount; i++) {
+                const auto bucket { m_counts[i].load(std::memory_order_relaxed) };
+                total.m_counts[i] += bucket;
+                count += bucket;
+            }
+            if (count == 0)
+                return;
+            total.m_count += count;
+            total.m_sum += m_sum.load(std::memory_order_relaxed);
+            total.m_min = std::min(total.m_min, m_min.load(std::memory_order_relaxed));
+            total.m_max = std::max(total.m_max, m_max.load(std::memory_order_relaxed));
+        }
+
+    private:
+        /// Only the owner thread writes: load + store instead of fetch_add
+        static void increment(std::atomic<std::uint64_t>& value, std::uint64_t delta)
+        {
+            value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        std::array<std::atomic<std::uint64_t>, HdrHistogram::bucketCount> m_counts {};
+        std::atomic<std::uint64_t> m_sum { 0 };
+        std::atomic<std::uint64_t> m_min { UINT64_MAX };
+        std::atomic<std::uint64_t> m_max { 0 };
+    };
+
+    using ThreadShard = PerThread<Shard>::Slot;
+
+    /// Shard of the calling thread for this histogram, created at its first record
+    Shard& threadShard()
+    {
+        return m_threadShards.local([this](std::shared_ptr<ThreadShard> shard) {
+            std::lock_guard lock { m_mutex };
+            mergeRetired();
+            m_shards.push_back(std::move(shard));
+        });
+    }
+
+    /// Moves the counts of exited threads into m_retired and frees their shards (mutex held)
+    void mergeRetired() const
+    {
+        std::erase_if(m_shards, [this](const auto& shard) {
+            if (!shard->retired.load(std::memory_order_acquire))
+                return false;
+            shard->value.addTo(m_retired);
+            return true;
+        });
+    }
+
+    PerThread<Shard> m_threadShards;
+    mutable std::mutex m_mutex;
+    // Merged by snapshot() too: both guarded by m_mutex
+    mutable std::vector<std::shared_ptr<ThreadShard>> m_shards;   // shards of running threads
+    mutable HdrHistogram m_retired;                                // counts of exited threads
+};
+
+
+/// Records the time spent in its scope (in ns) when destroyed
+class ScopedTimer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedTimer(LatencyHistogram& histogram) : m_histogram(histogram), m_start(Clock::now()) {}
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() { m_histogram.record(static_cast<std::uint64_t>(elapsed().count())); }
+
+    std::chrono::nanoseconds elapsed() const { return Clock::now() - m_start; }
+
+private:
+    LatencyHistogram& m_histogram;
+    const Clock::time_point m_start;
+};
+
+
+/// Named histograms and counters, exported together
+class Instrumentation
+{
+public:
+    using Counter = ShardedCounter<>;
+
+    /// Created at first call. References stay valid as long as the registry.
+    LatencyHistogram& histogram(const std::string& name) { return get(m_histograms, name); }
+    Counter& counter(const std::string& name) { return get(m_counters, name); }
+
+    /// One line per metric: count, mean, p50, p99, p999 and max (histograms in ns)
+    void writeText(std::ostream& out) const
+    {
+        std::lock_guard lock { m_mutex };
+        for (const auto& [name, histogram] : m_histograms) {
+            const auto h { histogram->snapshot() };
+            out << name << ": count=" << h.count() << " mean=" << static_cast<std::uint64_t>(h.mean())
+                << "ns p50=" << h.percentile(50) << "ns p99=" << h.percentile(99)
+                << "ns p999=" << h.percentile(99.9) << "ns max=" << h.max() << "ns\n";
+        }
+        for (const auto& [name, counter] : m_counters)
+            out << name << ": " << counter->value() << '\n';
+    }
+
+    /// {"histograms": {"name": {"count": ..., "p50": ...}}, "counters": {"name": value}}
+    void writeJson(std::ostream& out) const
+    {
+        std::lock_guard lock { m_mutex };
+        out << "{\"histograms\": {";
+        const char* separator { "" };
+        for (const auto& [name, histogram] : m_histograms) {
+            const auto h { histogram->snapshot() };
+            out << std::exchange(separator, ", ");
+            writeJsonString(out, name);
+            out << ": {\"count\": " << h.count()
+                << ", \"mean\": " << h.mean() << ", \"p50\": " << h.percentile(50)
+                << ", \"p99\": " << h.percentile(99) << ", \"p999\": " << h.percentile(99.9)
+                << ", \"max\": " << h.max() << '}';
+        }
+        out << "}, \"counters\": {";
+        separator = "";
+        for (const auto& [name, counter] : m_counters) {
+            out << std::exchange(separator, ", ");
+            writeJsonString(out, name);
+            out << ": " << counter->value();
+        }
+        out << "}}";
+    }
+
+private:
+    /// Name between quotes, with '"', '\\' and control characters escaped
+    static void writeJsonString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                constexpr char hex[] { "0123456789abcdef" };
+                out << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+            }
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+    template<typename T>
+    T& get(std::map<std::string, std::unique_ptr<T>>& metrics, const std::string& name)
+    {
+        std::lock_guard lock { m_mutex };
+        auto& metric { metrics[name] };
+        if (!metric)
+            metric = std::make_unique<T>();
+        return *metric;
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> m_histograms;
+    std::map<std::string, std::unique_ptr<Counter>> m_counters;
+};
+
+
+/// Registry shared by the whole program
+inline Instrumentation& instrumentation()
+{
+    static Instrumentation registry;
+    return registry;
+}
+
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,135 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+/*************************************
+ * JOIN
+ * Building a line with accumulate and 'previous + " " + to_string(item)' creates a new
+ * string at each step and copies everything built so far: O(n²) bytes copied.
+ *
+ * join() builds the line in a single string, in linear time:
+ * - size is computed (text) or bounded (numbers) first, so there is a single allocation
+ * - numbers are written in place with std::to_chars (shortest representation that
+ *   reads back to the same value, 1.2 and not 1.200000 as with to_string)
+ * - text is appended as is
+ * Works with any range (containers, views, adaptor views...). A projection can be given
+ * to select or convert what is written for each item, as for ranges algorithms.
+ * Other types are written with their operator<<.
+ * **********************************/
+
+
+namespace detail {
+
+// Upper bound of the number of characters written by to_chars for a number of type T
+template<typename T>
+constexpr std::size_t maxChars()
+{
+    if constexpr (std::is_floating_point<T>::value)
+        // sign, point, exponent (e-4932 for long double)
+        return std::numeric_limits<T>::max_digits10 + 8;
+    else
+        // sign and digits10 is rounded down
+        return std::numeric_limits<T>::digits10 + 3;
+}
+
+} // namespace detail
+
+
+/**
+ * @brief Appends projected items of 'range' to 'out', separated by 'separator'.
+ * 'out' may be reused from one call to the next to keep its capacity (one line after the other).
+ */
+template<std::ranges::input_range R, typename Projection = std::identity>
+std::string& joinTo(std::string& out, R&& range, std::string_view separator = " ", Projection proj = {})
+{
+    using Value = std::remove_cvref_t<std::invoke_result_t<Projection&, std::ranges::range_reference_t<R>>>;
+    bool first { true };
+    auto addSeparator = [&] {
+        if (!first)
+            out.append(separator);
+        first = false;
+    };
+
+    if constexpr (std::is_arithmetic<Value>::value && !std::is_same<Value, bool>::value
+                  && !std::is_same<Value, char>::value && std::ranges::sized_range<R>) {
+        // Room for the longest possible numbers, then trimmed to what was really written
+        const auto start { out.size() };
+        const auto count { static_cast<std::size_t>(std::ranges::size(range)) };
+        out.resize(start + count * (detail::maxChars<Value>() + separator.size()));
+        char* cursor { out.data() + start };
+        char* const end { out.data() + out.size() };
+        for (auto&& item : range) {
+            if (!first) {
+                separator.copy(cursor, separator.size());
+                cursor += separator.size();
+            }
+            first = false;
+            cursor = std::to_chars(cursor, end, std::invoke(proj, item)).ptr;
+        }
+        out.resize(static_cast<std::size_t>(cursor - out.data()));
+    }
+    else if constexpr (std::is_arithmetic<Value>::value && !std::is_same<Value, bool>::value
+                       && !std::is_same<Value, char>::value) {
+        // Size unknown: each number goes through a small local buffer
+        char buffer[detail::maxChars<Value>()];
+        for (auto&& item : range) {
+            addSeparator();
+            out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), std::invoke(proj, item)).ptr);
+        }
+    }
+    else if constexpr (std::is_convertible<const Value&, std::string_view>::value) {
+        // Exact size known after a first pass, when the range can be read twice
+        if constexpr (std::ranges::forward_range<R>) {
+            std::size_t length { 0 };
+            std::size_t count { 0 };
+            for (auto&& item : range) {
+                length += std::string_view(std::invoke(proj, item)).size();
+                count++;
+            }
+            out.reserve(out.size() + length + (count ? (count - 1) * separator.size() : 0));
+        }
+        for (auto&& item : range) {
+            addSeparator();
+            out.append(std::string_view(std::invoke(proj, item)));
+        }
+    }
+    else if constexpr (std::is_same<Value, char>::value) {
+        for (auto&& item : range) {
+            addSeparator();
+            out.push_back(std::invoke(proj, item));
+        }
+    }
+    else {
+        std::ostringstream st;
+        for (auto&& item : range) {
+            st.str({});
+            st << std::invoke(proj, item);
+            addSeparator();
+            out.append(st.view());
+        }
+    }
+    return out;
+}
+
+/// Returns projected items of 'range' separated by 'separator'
+template<std::ranges::input_range R, typename Projection = std::identity>
+std::string join(R&& range, std::string_view separator = " ", Projection proj = {})
+{
+    std::string out;
+    joinTo(out, std::forward<R>(range), separator, std::move(proj));
+    return out;
+}
+
+
+#endif // JOIN_H
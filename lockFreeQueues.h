@@ -0,0 +1,399 @@
+#ifndef LOCKFREEQUEUES_H
+#define LOCKFREEQUEUES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "sharedCounters.h"
+
+
+/*************************************
+ * LOCK FREE QUEUES
+ * A semaphore only passes a signal: data needs a queue next to it, protected by a mutex.
+ * A mutex + condition variable queue passes data, but every push and pop takes the lock,
+ * and a thread holding it may be descheduled while others wait.
+ *
+ * Both queues below are bounded (capacity rounded up to a power of 2, allocated once) and
+ * lock free: threads only synchronize through atomic indexes.
+ * - SpscQueue: one producer thread, one consumer thread. Producer only writes 'tail',
+ *   consumer only writes 'head', each keeps a cached copy of the other index and only reads
+ *   the shared one when its copy says the queue is full (or empty).
+ * - MpmcQueue: any number of producers and consumers (Dmitry Vyukov's bounded queue). Each
+ *   cell has a sequence number telling whether it is free or holds an item for a given
+ *   turn; threads claim positions with compare_exchange on the enqueue/dequeue counters.
+ *
+ * try_push/try_pop never block and return false when the queue is full/empty.
+ * Batch versions move several items at once: a single index update (SPSC) and a single
+ * wake up for the whole batch.
+ * push/pop (and pop_batch) block while the queue is full/empty. They wait with
+ * std::atomic::wait on an index (C++20): the thread sleeps in the kernel instead of spinning,
+ * and is woken by the next pop/push.
+ * Indexes are placed in different cache lines to avoid false sharing (see sharedCounters.h).
+ * **********************************/
+
+
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t rounded { 1 };
+        while (rounded < capacity)
+            rounded *= 2;
+        m_mask = rounded - 1;
+        m_items = std::allocator<T>().allocate(rounded);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue()
+    {
+        for (auto i { m_head.load() }; i != m_tail.load(); i++)
+            m_items[i & m_mask].~T();
+        std::allocator<T>().deallocate(m_items, m_mask + 1);
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+    /// Approximate when called while the other thread is working
+    std::size_t size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    /// Producer only
+    template<typename U>
+    bool try_push(U&& item)
+    {
+        const auto tail { m_tail.load(std::memory_order_relaxed) };
+        if (freeSlots(tail, 1) == 0)
+            return false;
+        ::new (static_cast<void*>(&m_items[tail & m_mask])) T(std::forward<U>(item));
+        publishTail(tail + 1);
+        return true;
+    }
+
+    /// Producer only: pushes items of [first, last) until the queue is full. Returns the number pushed.
+    template<typename InputIt>
+    std::size_t try_push_batch(InputIt first, InputIt last)
+    {
+        const auto tail { m_tail.load(std::memory_order_relaxed) };
+        const auto wanted { static_cast<std::size_t>(std::distance(first, last)) };
+        const auto count { std::min(wanted, freeSlots(tail, wanted)) };
+        for (std::size_t i { 0 }; i < count; i++, ++first)
+            ::new (static_cast<void*>(&m_items[(tail + i) & m_mask])) T(*first);
+        if (count)
+            publishTail(tail + count);
+        return count;
+    }
+
+    /// Consumer only
+    bool try_pop(T& item)
+    {
+        const auto head { m_head.load(std::memory_order_relaxed) };
+        if (readySlots(head, 1) == 0)
+            return false;
+        T& slot { m_items[head & m_mask] };
+        item = std::move(slot);
+        slot.~T();
+        publishHead(head + 1);
+        return true;
+    }
+
+    /// Consumer only: moves up to 'max' items to 'out'. Returns the number popped.
+    template<typename OutputIt>
+    std::size_t try_pop_batch(OutputIt out, std::size_t max)
+    {
+        const auto head { m_head.load(std::memory_order_relaxed) };
+        const auto count { std::min(max, readySlots(head, max)) };
+        for (std::size_t i { 0 }; i < count; i++) {
+            T& slot { m_items[(head + i) & m_mask] };
+            *out++ = std::move(slot);
+            slot.~T();
+        }
+        if (count)
+            publishHead(head + count);
+        return count;
+    }
+
+    /// Producer only: waits while the queue is full
+    template<typename U>
+    void push(U&& item)
+    {
+        while (!try_push(std::forward<U>(item)))
+            m_head.wait(m_tail.load(std::memory_order_relaxed) - capacity(), std::memory_order_acquire);
+    }
+
+    /// Producer only: waits until all items are pushed
+    template<typename InputIt>
+    void push_batch(InputIt first, InputIt last)
+    {
+        while (first != last) {
+            const auto pushed { try_push_batch(first, last) };
+            std::advance(first, pushed);
+            if (pushed == 0)
+                m_head.wait(m_tail.load(std::memory_order_relaxed) - capacity(), std::memory_order_acquire);
+        }
+    }
+
+    /// Consumer only: waits while the queue is empty
+    T pop()
+    {
+        T item;
+        while (!try_pop(item))
+            m_tail.wait(m_head.load(std::memory_order_relaxed), std::memory_order_acquire);
+        return item;
+    }
+
+    /// Consumer only: waits for at least one item, then moves up to 'max' items to 'out'
+    template<typename OutputIt>
+    std::size_t pop_batch(OutputIt out, std::size_t max)
+    {
+        while (true) {
+            if (const auto count { try_pop_batch(out, max) })
+                return count;
+            m_tail.wait(m_head.load(std::memory_order_relaxed), std::memory_order_acquire);
+        }
+    }
+
+private:
+    /// Free slots for the producer, shared head only read when the cached one says there are less than 'wanted'
+    std::size_t freeSlots(std::size_t tail, std::size_t wanted)
+    {
+        if (capacity() - (tail - m_headCache) < wanted)
+            m_headCache = m_head.load(std::memory_order_acquire);
+        return capacity() - (tail - m_headCache);
+    }
+
+    std::size_t readySlots(std::size_t head, std::size_t wanted)
+    {
+        if (m_tailCache - head < wanted)
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+        return m_tailCache - head;
+    }
+
+    void publishTail(std::size_t tail)
+    {
+        m_tail.store(tail, std::memory_order_release);
+        m_tail.notify_one();
+    }
+
+    void publishHead(std::size_t head)
+    {
+        m_head.store(head, std::memory_order_release);
+        m_head.notify_one();
+    }
+
+    T* m_items { nullptr };
+    std::size_t m_mask { 0 };
+    // Consumer side: written by the consumer, read by the producer when full
+    alignas(cacheLineSize) std::atomic<std::size_t> m_head { 0 };
+    std::size_t m_tailCache { 0 };
+    // Producer side
+    alignas(cacheLineSize) std::atomic<std::size_t> m_tail { 0 };
+    std::size_t m_headCache { 0 };
+};
+
+
+template<typename T>
+class MpmcQueue
+{
+public:
+    explicit MpmcQueue(std::size_t capacity)
+    {
+        std::size_t rounded { 2 };
+        while (rounded < capacity)
+            rounded *= 2;
+        m_mask = rounded - 1;
+        m_cells = std::make_unique<Cell[]>(rounded);
+        for (std::size_t i { 0 }; i < rounded; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue()
+    {
+        T item;
+        while (tryPopOne(item)) {
+        }
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+    /// Approximate when called while other threads are working
+    std::size_t size() const
+    {
+        const auto enqueued { m_enqueuePos.load(std::memory_order_acquire) };
+        const auto dequeued { m_dequeuePos.load(std::memory_order_acquire) };
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    bool empty() const { return size() == 0; }
+
+    template<typename U>
+    bool try_push(U&& item)
+    {
+        if (!tryPushOne(std::forward<U>(item)))
+            return false;
+        m_enqueuePos.notify_one();
+        return true;
+    }
+
+    /// Pushes items of [first, last) until the queue is full. Returns the number pushed.
+    template<typename InputIt>
+    std::size_t try_push_batch(InputIt first, InputIt last)
+    {
+        std::size_t count { 0 };
+        for (; first != last && tryPushOne(*first); ++first)
+            count++;
+        if (count)
+            m_enqueuePos.notify_all();
+        return count;
+    }
+
+    bool try_pop(T& item)
+    {
+        if (!tryPopOne(item))
+            return false;
+        m_dequeuePos.notify_one();
+        return true;
+    }
+
+    /// Moves up to 'max' items to 'out'. Returns the number popped.
+    template<typename OutputIt>
+    std::size_t try_pop_batch(OutputIt out, std::size_t max)
+    {
+        std::size_t count { 0 };
+        T item;
+        while (count < max && tryPopOne(item)) {
+            *out++ = std::move(item);
+            count++;
+        }
+        if (count)
+            m_dequeuePos.notify_all();
+        return count;
+    }
+
+    /// Waits while the queue is full
+    template<typename U>
+    void push(U&& item)
+    {
+        while (!try_push(std::forward<U>(item)))
+            waitForPop();
+    }
+
+    /// Waits until all items are pushed
+    template<typename InputIt>
+    void push_batch(InputIt first, InputIt last)
+    {
+        while (first != last) {
+            const auto pushed { try_push_batch(first, last) };
+            std::advance(first, pushed);
+            if (pushed == 0)
+                waitForPop();
+        }
+    }
+
+    /// Waits while the queue is empty
+    T pop()
+    {
+        T item;
+        while (!try_pop(item))
+            waitForPush();
+        return item;
+    }
+
+    /// Waits for at least one item, then moves up to 'max' items to 'out'
+    template<typename OutputIt>
+    std::size_t pop_batch(OutputIt out, std::size_t max)
+    {
+        while (true) {
+            if (const auto count { try_pop_batch(out, max) })
+                return count;
+            waitForPush();
+        }
+    }
+
+private:
+    struct Cell
+    {
+        // pos: free for the push at position 'pos'. pos + 1: holds the item pushed at 'pos'.
+        std::atomic<std::size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    template<typename U>
+    bool tryPushOne(U&& item)
+    {
+        auto pos { m_enqueuePos.load(std::memory_order_relaxed) };
+        while (true) {
+            Cell& cell { m_cells[pos & m_mask] };
+            const auto sequence { cell.sequence.load(std::memory_order_acquire) };
+            const auto diff { static_cast<std::ptrdiff_t>(sequence - pos) };
+            if (diff == 0) {
+                // Cell free for this turn: claim the position
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ::new (static_cast<void*>(cell.storage)) T(std::forward<U>(item));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;   // cell still holds the item of the previous turn: full
+            else
+                pos = m_enqueuePos.load(std::memory_order_relaxed);   // another producer took it
+        }
+    }
+
+    bool tryPopOne(T& item)
+    {
+        auto pos { m_dequeuePos.load(std::memory_order_relaxed) };
+        while (true) {
+            Cell& cell { m_cells[pos & m_mask] };
+            const auto sequence { cell.sequence.load(std::memory_order_acquire) };
+            const auto diff { static_cast<std::ptrdiff_t>(sequence - (pos + 1)) };
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* stored { std::launder(reinterpret_cast<T*>(cell.storage)) };
+                    item = std::move(*stored);
+                    stored->~T();
+                    // Free for the push one turn later
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false;   // item not pushed yet: empty
+            else
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Sleeps until a producer claims a position. The item may not be visible yet: callers loop.
+    void waitForPush()
+    {
+        const auto enqueued { m_enqueuePos.load(std::memory_order_acquire) };
+        if (m_dequeuePos.load(std::memory_order_acquire) >= enqueued)
+            m_enqueuePos.wait(enqueued, std::memory_order_acquire);
+    }
+
+    void waitForPop()
+    {
+        const auto dequeued { m_dequeuePos.load(std::memory_order_acquire) };
+        if (m_enqueuePos.load(std::memory_order_acquire) - dequeued >= capacity())
+            m_dequeuePos.wait(dequeued, std::memory_order_acquire);
+    }
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask { 0 };
+    alignas(cacheLineSize) std::atomic<std::size_t> m_enqueuePos { 0 };
+    alignas(cacheLineSize) std::atomic<std::size_t> m_dequeuePos { 0 };
+};
+
+
+#endif // LOCKFREEQUEUES_H
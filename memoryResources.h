@@ -0,0 +1,98 @@
+#ifndef MEMORYRESOURCES_H
+#define MEMORYRESOURCES_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <ostream>
+
+
+/*************************************
+ * POLYMORPHIC MEMORY RESOURCES (pmr, C++17)
+ * Node based containers (list, set, map) allocate each node from the global heap:
+ * one malloc and one free per item, shared by all threads.
+ * With pmr, a container gets its memory from a 'memory resource' given at construction:
+ *     std::pmr::list<int> l { &resource };
+ * std::pmr::list<T> is simply std::list<T, std::pmr::polymorphic_allocator<T>>.
+ * Standard resources:
+ * - monotonic_buffer_resource (arena): hands out memory from large blocks, one after the
+ *   other. Deallocation does nothing, everything is freed at once when the resource is
+ *   destroyed (or release() is called). Fastest, for data built then thrown away as a whole.
+ * - unsynchronized_pool_resource: pools of fixed size blocks, blocks are reused after
+ *   deallocation. For one thread only. synchronized_pool_resource is its thread safe version.
+ * Both get their large blocks from an 'upstream' resource (global heap by default).
+ *
+ * StatisticsResource below is a resource that forwards to an upstream resource and counts
+ * allocations, bytes and peak usage. Placed under an arena, it shows how many requests
+ * really reach the heap; placed above, how many requests the container makes.
+ * **********************************/
+
+
+class StatisticsResource : public std::pmr::memory_resource
+{
+public:
+    explicit StatisticsResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream(upstream)
+    {}
+
+    std::size_t allocations() const { return m_allocations; }
+    std::size_t deallocations() const { return m_deallocations; }
+    /// Total of bytes ever allocated
+    std::size_t bytesAllocated() const { return m_bytesAllocated; }
+    /// Bytes allocated and not yet deallocated
+    std::size_t bytesInUse() const { return m_bytesInUse; }
+    /// Highest value of bytesInUse
+    std::size_t peakBytes() const { return m_peakBytes; }
+
+    /// Resets counters, except bytes in use (still allocated)
+    void resetCounters()
+    {
+        m_allocations = 0;
+        m_deallocations = 0;
+        m_bytesAllocated = 0;
+        m_peakBytes = m_bytesInUse.load();
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void* p { m_upstream->allocate(bytes, alignment) };
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+        const std::size_t inUse { m_bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes };
+        std::size_t peak { m_peakBytes.load(std::memory_order_relaxed) };
+        while (inUse > peak && !m_peakBytes.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {
+        }
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        m_upstream->deallocate(p, bytes, alignment);
+        m_deallocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* m_upstream;
+    // Atomic: the same resource may be used by several threads (above a synchronized pool or the heap)
+    std::atomic<std::size_t> m_allocations { 0 };
+    std::atomic<std::size_t> m_deallocations { 0 };
+    std::atomic<std::size_t> m_bytesAllocated { 0 };
+    std::atomic<std::size_t> m_bytesInUse { 0 };
+    std::atomic<std::size_t> m_peakBytes { 0 };
+};
+
+inline std::ostream& operator<<(std::ostream& os, const StatisticsResource& resource)
+{
+    os << "allocations: " << resource.allocations() << " / deallocations: " << resource.deallocations()
+       << " / bytes: " << resource.bytesAllocated() << " / peak: " << resource.peakBytes();
+    return os;
+}
+
+
+#endif // MEMORYRESOURCES_H
@@ -5,12 +5,15 @@
 #include <list>
 #include <array>
 #include <queue>
+#include <stack>
 #include <deque>
 #include <set>
 #include <map>
 #include <ostream>
 #include <type_traits>
 
+#include "adaptorView.h"
+
 
 /*************************************
  * BASE PRINCIPLE
@@ -43,16 +46,17 @@ struct is_type_container {
   static const bool value = false;
 };
 
-// Metaprogramming function specialized for vectors. Is templatized too to match vectors of any type.
+// Metaprogramming function specialized for vectors. Is templatized too to match vectors of any type,
+// with any allocator (such as std::pmr::vector).
 // Returns true to enable function for vectors.
-template<typename T>
-struct is_type_container<std::vector<T>> {
+template<typename T, typename A>
+struct is_type_container<std::vector<T, A>> {
   static const bool value = true;
 };
 
 // enable for lists
-template<typename T>
-struct is_type_container<std::list<T>> {
+template<typename T, typename A>
+struct is_type_container<std::list<T, A>> {
   static const bool value = true;
 };
 
@@ -63,15 +67,33 @@ struct is_type_container<std::array<T, n>> {
 };
 
 // ennable for deque
-template<typename T>
-struct is_type_container<std::deque<T>> {
+template<typename T, typename A>
+struct is_type_container<std::deque<T, A>> {
   static const bool value = true;
 };
 
 
 // enable for sets
+template<typename T, typename C, typename A>
+struct is_type_container<std::set<T, C, A>> {
+  static const bool value = true;
+};
+
+// Maps are not part of is_type_container because they need their own printer (key=value).
+// Any associative container iterating over key/value pairs can be enabled.
 template<typename T>
-struct is_type_container<std::set<T>> {
+struct is_type_map {
+  static const bool value = false;
+};
+
+template<typename K, typename V, typename C, typename A>
+struct is_type_map<std::map<K, V, C, A>> {
+  static const bool value = true;
+};
+
+// enable for views over queue, stack and priority_queue (see adaptorView.h)
+template<typename Iterator>
+struct is_type_container<AdaptorView<Iterator>> {
   static const bool value = true;
 };
 
@@ -101,36 +123,32 @@ typename std::enable_if<is_type_container<T>::value, std::ostream&>::type
 operator<<(std::ostream& os, const T& container) {
     os << "Size: " << container.size() << " / ";
     os << "Items: ";
-    for (const auto item : container)
+    for (const auto& item : container)
         os << item << " ";
     return os;
 }
 
 /**
- * @brief Template specialization: Print size and items of containers of type 'queue'.
- * It is not possible to iterate over queue. So local copy is created (copy of parameters)
- * Each item is accessed using 'front' and is removed with 'pop' to access next item.
- * Sequence is repeated until queue is empty
+ * @brief Print size and items of container adaptors: 'queue', 'stack' and 'priority_queue'.
+ * It is not possible to iterate over adaptors. Instead of copying the adaptor and popping
+ * each item, a view over the wrapped container is printed (see adaptorView.h).
+ * No copy, no allocation, adaptor is left untouched.
  */
-template<typename T,typename U>
-std::ostream& operator<<(std::ostream& os, std::queue<T, U> container) {
-    os << "Size: " << container.size() << " / ";
-    os << "Items: ";
-    while (!container.empty()) {
-        os << container.front() << " ";
-        container.pop();
-    }
-    return os;
+template<typename T>
+typename std::enable_if<is_type_adaptor<T>::value, std::ostream&>::type
+operator<<(std::ostream& os, const T& adaptor) {
+    return os << adaptorView(adaptor);
 }
 
 /**
- * @brief Template specialization: Print all items of 'map'.
+ * @brief Print all items of maps: any type enabled by is_type_map.
  */
-template<typename K, typename V>
-std::ostream& operator<<(std::ostream& os, const std::map<K, V> &m) {
+template<typename T>
+typename std::enable_if<is_type_map<T>::value, std::ostream&>::type
+operator<<(std::ostream& os, const T& m) {
     os << "Size: " << m.size() << " / ";
     os << "Items: ";
-    for (const auto item : m)
+    for (const auto& item : m)
         os << item.first << "=" << item.second << " ";
     return os;
 }
@@ -0,0 +1,462 @@
+#ifndef OPENHASHMAP_H
+#define OPENHASHMAP_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * OPEN ADDRESSING HASH MAP (SwissTable design)
+ * std::unordered_map stores each item in its own node, chained in buckets: a lookup
+ * reads the bucket array, then follows pointers from node to node.
+ * open_hash_map stores items directly in a single array of slots. Next to it, one
+ * control byte per slot tells whether slot is empty, deleted or full, and for full
+ * slots keeps 7 bits of the hash of its key.
+ * Slots are grouped by 16: a lookup loads the 16 control bytes of a group at once
+ * (one SSE2 register) and only compares keys of slots whose 7 bits match.
+ * Most lookups thus read one group of control bytes and one slot.
+ * Groups are probed one after the other (quadratic probing) until a group with an
+ * empty slot is found.
+ *
+ * Erased slots are marked 'deleted' unless their group has an empty slot: such a group
+ * was never full, so no lookup ever went beyond it.
+ * Table grows (x2) when 7/8 of the slots are used (full or deleted).
+ *
+ * Default hash and equality are transparent for std::string keys: find("foo") or
+ * find(string_view) don't build a temporary std::string.
+ * As with std::unordered_map, iteration order is unspecified. Iterators are invalidated
+ * when table grows.
+ * **********************************/
+
+
+/// Hash used by default: std::hash, made transparent for strings
+template<typename K>
+struct TransparentHash : std::hash<K> {
+};
+
+template<>
+struct TransparentHash<std::string> {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view key) const { return std::hash<std::string_view> {}(key); }
+};
+
+
+namespace hash_detail {
+
+using Control = std::int8_t;
+inline constexpr Control empty { -128 };      // 0b10000000
+inline constexpr Control deleted { -2 };      // 0b11111110
+// Full slots: 0b0xxxxxxx, 7 bits of the hash
+inline constexpr std::size_t groupSize { 16 };
+
+/// Spreads bits of poor hash functions (std::hash of integers is the identity)
+inline std::size_t mix(std::size_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/// Bit i is set when control byte i of the group is equal to 'value'
+inline std::uint32_t match(const Control* group, Control value)
+{
+#ifdef __SSE2__
+    const __m128i controls { _mm_load_si128(reinterpret_cast<const __m128i*>(group)) };
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(value))));
+#else
+    std::uint32_t mask { 0 };
+    for (std::size_t i { 0 }; i < groupSize; i++)
+        mask |= static_cast<std::uint32_t>(group[i] == value) << i;
+    return mask;
+#endif
+}
+
+/// Bit i is set when slot i of the group is empty or deleted (sign bit set)
+inline std::uint32_t matchFree(const Control* group)
+{
+#ifdef __SSE2__
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    std::uint32_t mask { 0 };
+    for (std::size_t i { 0 }; i < groupSize; i++)
+        mask |= static_cast<std::uint32_t>(group[i] < 0) << i;
+    return mask;
+#endif
+}
+
+} // namespace hash_detail
+
+
+template<typename K, typename V, typename Hash = TransparentHash<K>, typename KeyEqual = std::equal_to<>>
+class open_hash_map
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+
+    template<bool isConst>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = open_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<isConst, const value_type*, value_type*>;
+        using reference = std::conditional_t<isConst, const value_type&, value_type&>;
+
+        Iterator() = default;
+        Iterator(const hash_detail::Control* control, pointer slot, const hash_detail::Control* last)
+            : m_control(control), m_slot(slot), m_last(last)
+        {
+            skipFree();
+        }
+        // iterator -> const_iterator
+        operator Iterator<true>() const { return { m_control, m_slot, m_last }; }
+
+        reference operator*() const { return *m_slot; }
+        pointer operator->() const { return m_slot; }
+        Iterator& operator++()
+        {
+            ++m_control;
+            ++m_slot;
+            skipFree();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            auto previous { *this };
+            ++*this;
+            return previous;
+        }
+        bool operator==(const Iterator& other) const { return m_slot == other.m_slot; }
+
+    private:
+        void skipFree()
+        {
+            while (m_control != m_last && *m_control < 0) {
+                ++m_control;
+                ++m_slot;
+            }
+        }
+
+        friend class open_hash_map;
+
+        const hash_detail::Control* m_control { nullptr };
+        pointer m_slot { nullptr };
+        const hash_detail::Control* m_last { nullptr };
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    open_hash_map() = default;
+
+    open_hash_map(std::initializer_list<std::pair<K, V>> items)
+    {
+        reserve(items.size());
+        for (const auto& item : items)
+            emplace(item.first, item.second);
+    }
+
+    open_hash_map(const open_hash_map& other)
+    {
+        reserve(other.size());
+        for (const auto& item : other)
+            emplace(item.first, item.second);
+    }
+
+    open_hash_map(open_hash_map&& other) noexcept
+    {
+        swap(other);
+    }
+
+    open_hash_map& operator=(open_hash_map other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~open_hash_map()
+    {
+        destroy();
+    }
+
+    void swap(open_hash_map& other) noexcept
+    {
+        std::swap(m_controls, other.m_controls);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_used, other.m_used);
+    }
+
+    iterator begin() { return { m_controls, m_slots, m_controls + m_capacity }; }
+    iterator end() { return { m_controls + m_capacity, m_slots + m_capacity, m_controls + m_capacity }; }
+    const_iterator begin() const { return const_cast<open_hash_map*>(this)->begin(); }
+    const_iterator end() const { return const_cast<open_hash_map*>(this)->end(); }
+
+    size_type size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    void clear()
+    {
+        destroy();
+        m_controls = nullptr;
+        m_slots = nullptr;
+        m_capacity = m_size = m_used = 0;
+    }
+
+    /// Makes room for 'n' items without growing
+    void reserve(size_type n)
+    {
+        size_type capacity { hash_detail::groupSize };
+        while (capacity * 7 / 8 < n)
+            capacity *= 2;
+        if (capacity > m_capacity)
+            rehash(capacity);
+    }
+
+    template<typename Key>
+    iterator find(const Key& key)
+    {
+        const auto index { findIndex(key) };
+        return index == npos ? end() : iteratorAt(index);
+    }
+
+    template<typename Key>
+    const_iterator find(const Key& key) const
+    {
+        return const_cast<open_hash_map*>(this)->find(key);
+    }
+
+    template<typename Key>
+    size_type count(const Key& key) const { return findIndex(key) != npos; }
+
+    template<typename Key>
+    bool contains(const Key& key) const { return findIndex(key) != npos; }
+
+    template<typename Key>
+    V& at(const Key& key)
+    {
+        const auto index { findIndex(key) };
+        if (index == npos)
+            throw std::out_of_range("open_hash_map::at: key not found");
+        return m_slots[index].second;
+    }
+
+    template<typename Key>
+    const V& at(const Key& key) const
+    {
+        return const_cast<open_hash_map*>(this)->at(key);
+    }
+
+    /// Inserts the item if key is not found. Returns the item and whether it was inserted.
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        const auto h { hash(key) };
+        auto index { findIndex(key, h) };
+        if (index != npos)
+            return { iteratorAt(index), false };
+
+        if ((m_used + 1) * 8 > m_capacity * 7)
+            // Only deleted slots to recycle: same size is enough
+            rehash(m_size + 1 <= m_capacity * 7 / 16 ? m_capacity : std::max(m_capacity * 2, hash_detail::groupSize));
+        index = findFree(h);
+        ::new (static_cast<void*>(m_slots + index)) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        if (m_controls[index] == hash_detail::empty)
+            m_used++;
+        m_controls[index] = h2(h);
+        m_size++;
+        return { iteratorAt(index), true };
+    }
+
+    template<typename Key, typename Value>
+    std::pair<iterator, bool> emplace(Key&& key, Value&& value)
+    {
+        return try_emplace(std::forward<Key>(key), std::forward<Value>(value));
+    }
+
+    // Hint is meaningless for a hash map: same as emplace
+    template<typename Key, typename Value>
+    iterator emplace_hint(const_iterator, Key&& key, Value&& value)
+    {
+        return emplace(std::forward<Key>(key), std::forward<Value>(value)).first;
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V>& item)
+    {
+        return try_emplace(item.first, item.second);
+    }
+
+    template<typename Key>
+    V& operator[](Key&& key)
+    {
+        return try_emplace(std::forward<Key>(key)).first->second;
+    }
+
+    /// Iterators go to erase(const_iterator), as with std::map
+    template<typename Key>
+        requires(!std::is_convertible_v<const Key&, const_iterator>)
+    size_type erase(const Key& key)
+    {
+        const auto index { findIndex(key) };
+        if (index == npos)
+            return 0;
+        eraseAt(index);
+        return 1;
+    }
+
+    /// Other items stay in place: returns the next item
+    iterator erase(const_iterator it)
+    {
+        const auto index { static_cast<size_type>(it.m_slot - m_slots) };
+        eraseAt(index);
+        return iteratorAt(index + 1);
+    }
+
+    bool operator==(const open_hash_map& other) const
+    {
+        if (m_size != other.m_size)
+            return false;
+        for (const auto& [key, value] : *this) {
+            auto it { other.find(key) };
+            if (it == other.end() || !(it->second == value))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_type npos { static_cast<size_type>(-1) };
+
+    template<typename Key>
+    std::size_t hash(const Key& key) const { return hash_detail::mix(m_hash(key)); }
+    // 7 low bits are kept in the control byte, others select the group
+    static hash_detail::Control h2(std::size_t h) { return static_cast<hash_detail::Control>(h & 0x7f); }
+    static std::size_t h1(std::size_t h) { return h >> 7; }
+
+    iterator iteratorAt(size_type index) { return { m_controls + index, m_slots + index, m_controls + m_capacity }; }
+
+    template<typename Key>
+    size_type findIndex(const Key& key) const { return m_capacity ? findIndex(key, hash(key)) : npos; }
+
+    template<typename Key>
+    size_type findIndex(const Key& key, std::size_t h) const
+    {
+        if (!m_capacity)
+            return npos;
+        const size_type groupMask { m_capacity / hash_detail::groupSize - 1 };
+        size_type group { h1(h) & groupMask };
+        for (size_type probe { 1 };; probe++) {
+            const hash_detail::Control* controls { m_controls + group * hash_detail::groupSize };
+            for (auto candidates { hash_detail::match(controls, h2(h)) }; candidates; candidates &= candidates - 1) {
+                const size_type index { group * hash_detail::groupSize + static_cast<size_type>(std::countr_zero(candidates)) };
+                if (m_equal(m_slots[index].first, key))
+                    return index;
+            }
+            if (hash_detail::match(controls, hash_detail::empty))
+                return npos;
+            group = (group + probe) & groupMask;
+        }
+    }
+
+    /// First empty or deleted slot on the probe sequence of 'h'
+    size_type findFree(std::size_t h) const
+    {
+        const size_type groupMask { m_capacity / hash_detail::groupSize - 1 };
+        size_type group { h1(h) & groupMask };
+        for (size_type probe { 1 };; probe++) {
+            if (const auto free { hash_detail::matchFree(m_controls + group * hash_detail::groupSize) })
+                return group * hash_detail::groupSize + static_cast<size_type>(std::countr_zero(free));
+            group = (group + probe) & groupMask;
+        }
+    }
+
+    void eraseAt(size_type index)
+    {
+        m_slots[index].~value_type();
+        const auto* group { m_controls + index / hash_detail::groupSize * hash_detail::groupSize };
+        if (hash_detail::match(group, hash_detail::empty)) {
+            m_controls[index] = hash_detail::empty;
+            m_used--;
+        }
+        else
+            m_controls[index] = hash_detail::deleted;
+        m_size--;
+    }
+
+    void rehash(size_type capacity)
+    {
+        open_hash_map bigger;
+        bigger.allocate(capacity);
+        for (size_type i { 0 }; i < m_capacity; i++) {
+            if (m_controls[i] < 0)
+                continue;
+            const auto h { hash(m_slots[i].first) };
+            const auto index { bigger.findFree(h) };
+            ::new (static_cast<void*>(bigger.m_slots + index)) value_type(std::move(const_cast<K&>(m_slots[i].first)), std::move(m_slots[i].second));
+            bigger.m_controls[index] = h2(h);
+        }
+        bigger.m_size = bigger.m_used = m_size;
+        swap(bigger);
+    }
+
+    void allocate(size_type capacity)
+    {
+        m_controls = static_cast<hash_detail::Control*>(::operator new(capacity, std::align_val_t { hash_detail::groupSize }));
+        std::memset(m_controls, hash_detail::empty, capacity);
+        m_slots = std::allocator<value_type>().allocate(capacity);
+        m_capacity = capacity;
+    }
+
+    void destroy()
+    {
+        if (!m_capacity)
+            return;
+        for (size_type i { 0 }; i < m_capacity; i++)
+            if (m_controls[i] >= 0)
+                m_slots[i].~value_type();
+        ::operator delete(m_controls, std::align_val_t { hash_detail::groupSize });
+        std::allocator<value_type>().deallocate(m_slots, m_capacity);
+    }
+
+    hash_detail::Control* m_controls { nullptr };
+    value_type* m_slots { nullptr };
+    size_type m_capacity { 0 };     // power of 2, multiple of group size
+    size_type m_size { 0 };         // full slots
+    size_type m_used { 0 };         // full and deleted slots
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+};
+
+
+// enable operator<< (key=value)
+template<typename K, typename V, typename H, typename E>
+struct is_type_map<open_hash_map<K, V, H, E>> {
+  static const bool value = true;
+};
+
+
+#endif // OPENHASHMAP_H
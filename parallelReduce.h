@@ -0,0 +1,93 @@
+#ifndef PARALLELREDUCE_H
+#define PARALLELREDUCE_H
+
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+
+/*************************************
+ * PARALLEL REDUCTION
+ * Three ways to reduce a range with any binary operation (sum, product, max...):
+ * - serialReduce: plain loop, one item after the other. Reference for speedup.
+ * - policyReduce: std::reduce with the std::execution::par_unseq policy (C++17).
+ *   The standard library splits the work (with libstdc++, on top of TBB when available).
+ * - threadedReduce: hand-rolled version. The range is split in one chunk per thread,
+ *   each thread reduces its chunk and partial results are combined at the end.
+ *
+ * IMPORTANT
+ * As for std::reduce, parallel versions may group and reorder items:
+ * the operation must be associative and commutative (max, +, *...).
+ * With floating point values, result may slightly differ from the serial one.
+ * **********************************/
+
+
+/// Reduces items one after the other, starting from 'init'
+template<typename InputIt, typename T, typename BinaryOp>
+T serialReduce(InputIt first, InputIt last, T init, BinaryOp op)
+{
+    for (; first != last; ++first)
+        init = op(init, *first);
+    return init;
+}
+
+/// Reduces items with std::reduce and the parallel + vectorized execution policy
+template<typename RandomIt, typename T, typename BinaryOp>
+T policyReduce(RandomIt first, RandomIt last, T init, BinaryOp op)
+{
+    return std::reduce(std::execution::par_unseq, first, last, init, op);
+}
+
+/**
+ * @brief Reduces items with 'threadCount' threads, each working on a contiguous chunk.
+ * Calling thread handles the last chunk. Small ranges are not worth starting threads
+ * and are reduced serially. An exception thrown by 'op' is rethrown in the calling thread.
+ */
+template<typename RandomIt, typename T, typename BinaryOp>
+T threadedReduce(RandomIt first, RandomIt last, T init, BinaryOp op,
+                 unsigned threadCount = std::thread::hardware_concurrency())
+{
+    // Below that many items per thread, starting a thread costs more than it saves
+    constexpr std::ptrdiff_t minItemsPerThread { 16 * 1024 };
+
+    const auto size { std::distance(first, last) };
+    const auto chunks { std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(threadCount, size / minItemsPerThread)) };
+    if (chunks == 1)
+        return serialReduce(first, last, init, op);
+
+    // Each chunk starts from its first item: no identity value needed for 'op'
+    std::vector<T> partials(static_cast<std::size_t>(chunks), init);
+    std::vector<std::exception_ptr> errors(static_cast<std::size_t>(chunks));
+    auto reduceChunk = [&](std::ptrdiff_t chunk) {
+        try {
+            auto chunkFirst { first + size * chunk / chunks };
+            auto chunkLast { first + size * (chunk + 1) / chunks };
+            T partial = *chunkFirst;
+            partials[chunk] = serialReduce(++chunkFirst, chunkLast, partial, op);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    // jthread: if starting a thread fails, the ones already started are joined before the
+    // exception leaves (a joinable std::thread would call std::terminate when destroyed)
+    std::vector<std::jthread> threads;
+    threads.reserve(static_cast<std::size_t>(chunks - 1));
+    for (std::ptrdiff_t chunk { 0 }; chunk < chunks - 1; chunk++)
+        threads.emplace_back(reduceChunk, chunk);
+    reduceChunk(chunks - 1);
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+    return serialReduce(partials.begin(), partials.end(), init, op);
+}
+
+
+#endif // PARALLELREDUCE_H
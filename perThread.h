@@ -0,0 +1,98 @@
+#ifndef PERTHREAD_H
+#define PERTHREAD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+/*************************************
+ * PER-THREAD OBJECTS OF A SHARED OWNER
+ * A logger or a histogram used by several threads gives each thread its own object (a
+ * 'slot': a ring, a shard...) so that threads never write the same memory. A thread_local
+ * variable can't do it alone: it is static, shared by all instances of the class.
+ *
+ * PerThread<T> keeps, for each thread, the slots it created for each owner:
+ * - owners are told apart by an id, unique even if an owner is created at the address of
+ *   a destroyed one
+ * - a slot is shared by its thread and its owner (shared_ptr): it lives until both are done
+ *   with it, whichever ends first
+ * - when a thread exits, its slots are marked 'retired': the owner may then read them one
+ *   last time (drain, merge) and free them, threads created per job don't pile up slots
+ * - when an owner is destroyed first, the threads drop its slots the next time they create
+ *   one (only the thread still holds them)
+ * **********************************/
+
+
+/// Object of one thread for one owner
+template<typename T>
+struct PerThreadSlot
+{
+    template<typename... Args>
+    explicit PerThreadSlot(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T value;
+    std::atomic<bool> retired { false };   // set (release) when the thread exits: no more writes to value
+};
+
+
+template<typename T>
+class PerThread
+{
+public:
+    using Slot = PerThreadSlot<T>;
+
+    PerThread() = default;
+    PerThread(const PerThread&) = delete;
+    PerThread& operator=(const PerThread&) = delete;
+
+    /// Slot of the calling thread, built from 'args' at its first call. 'onCreate' is then
+    /// given the new slot (std::shared_ptr<Slot>), for the owner to keep it.
+    template<typename OnCreate, typename... Args>
+    T& local(OnCreate&& onCreate, Args&&... args)
+    {
+        auto& slots { threadSlots().slots };
+        for (const auto& [owner, slot] : slots)
+            if (owner == m_id)
+                return slot->value;
+
+        std::erase_if(slots, [](const auto& entry) { return entry.second.use_count() == 1; });
+        auto slot { std::make_shared<Slot>(std::forward<Args>(args)...) };
+        slots.emplace_back(m_id, slot);
+        std::forward<OnCreate>(onCreate)(std::move(slot));
+        return slots.back().second->value;
+    }
+
+private:
+    /// Slots of a thread for all owners, retired when the thread exits
+    struct ThreadSlots
+    {
+        std::vector<std::pair<std::uint64_t, std::shared_ptr<Slot>>> slots;
+
+        ~ThreadSlots()
+        {
+            for (const auto& [owner, slot] : slots)
+                slot->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    static ThreadSlots& threadSlots()
+    {
+        thread_local ThreadSlots slots;
+        return slots;
+    }
+
+    static std::uint64_t nextId()
+    {
+        static std::atomic<std::uint64_t> id { 0 };
+        return ++id;
+    }
+
+    const std::uint64_t m_id { nextId() };
+};
+
+
+#endif // PERTHREAD_H
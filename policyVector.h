@@ -0,0 +1,535 @@
+#ifndef POLICYVECTOR_H
+#define POLICYVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/*************************************
+ * POLICY BASED VECTOR
+ * A container makes several independent choices: where items live, how much it grows when
+ * full, where memory comes from, whether indexes are checked. std::vector fixes all of them.
+ * With 'policy based design', each choice is a template parameter (a 'policy'): any
+ * combination can be picked per use, at compile time. Policies are stateless (static
+ * functions) or live inside the container: no virtual call, no runtime test, no extra size.
+ *
+ *     policy_vector<T, Storage, Growth, Allocator, Bounds>
+ *
+ * Storage (a template template parameter: Storage<T, Allocator>)
+ * - HeapStorage: one block from the allocator, items moved to a new block when it grows.
+ * - InlineStorage: first items inside the object (16 by default), then as HeapStorage.
+ *   Other sizes: template<typename T, typename A> using InlineStorage64 = InlineStorage<T, A, 64>;
+ * - MmapStorage: pages mapped from the kernel, trivially copyable items only. Growing uses
+ *   mremap (Linux): the kernel moves page table entries instead of copying items, often
+ *   extending the mapping in place. Capacity is rounded up to whole pages. Ignores Allocator.
+ * Growth: capacity when the vector is full
+ * - Growth1_5x, Growth2x: capacity times 1.5 or 2. push_back is amortized constant time.
+ *   2x reallocates less often, 1.5x wastes less memory and lets freed blocks be reused.
+ * - ExactGrowth: just what is needed. No wasted memory, but push_back reallocates each
+ *   time (quadratic): for sizes known up front (reserve, resize).
+ * Allocator: where HeapStorage and InlineStorage get their blocks
+ * - StdAllocator: operator new.
+ * - ArenaAllocator: per thread monotonic arena (std::pmr::monotonic_buffer_resource).
+ *   Allocation is a pointer increment and deallocation does nothing: memory is only given
+ *   back by ArenaAllocator::release(), which the owner calls once no vector uses it.
+ * - HugePageAllocator: blocks of 2 MB and more are mapped aligned on 2 MB and marked for
+ *   transparent huge pages (madvise): one TLB entry covers 2 MB instead of 4 KB, fewer TLB
+ *   misses on random access to large arrays. Smaller blocks use operator new.
+ * Bounds: operator[] checks the index (throws out_of_range) with BoundsChecked, not with
+ * NoBoundsCheck. at() always checks.
+ * **********************************/
+
+
+namespace policy_detail {
+
+/// Moves 'count' items to uninitialized memory 'to', destroys them in 'from'
+template<typename T>
+void relocate(T* from, std::size_t count, T* to)
+{
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (count)
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+    }
+    else {
+        // Copy if moving may throw: items must stay valid in 'from' if it fails
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            std::uninitialized_move(from, from + count, to);
+        else
+            std::uninitialized_copy(from, from + count, to);
+        std::destroy(from, from + count);
+    }
+}
+
+inline std::size_t pageSize()
+{
+    static const std::size_t size { static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) };
+    return size;
+}
+
+inline std::size_t roundUp(std::size_t value, std::size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace policy_detail
+
+
+/* GROWTH POLICIES */
+
+template<std::size_t Numerator, std::size_t Denominator>
+struct GrowthFactor
+{
+    static_assert(Numerator > Denominator, "GrowthFactor: factor must be greater than 1");
+
+    static std::size_t next(std::size_t capacity, std::size_t needed)
+    {
+        return std::max(needed, capacity * Numerator / Denominator);
+    }
+};
+
+using Growth1_5x = GrowthFactor<3, 2>;
+using Growth2x = GrowthFactor<2, 1>;
+
+struct ExactGrowth
+{
+    static std::size_t next(std::size_t, std::size_t needed) { return needed; }
+};
+
+
+/* ALLOCATOR POLICIES */
+
+struct StdAllocator
+{
+    static void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        return ::operator new(bytes, std::align_val_t { alignment });
+    }
+
+    static void deallocate(void* p, std::size_t bytes, std::size_t alignment)
+    {
+        ::operator delete(p, bytes, std::align_val_t { alignment });
+    }
+};
+
+struct ArenaAllocator
+{
+    static void* allocate(std::size_t bytes, std::size_t alignment) { return arena().allocate(bytes, alignment); }
+    static void deallocate(void*, std::size_t, std::size_t) {}
+
+    /// Frees all memory of the calling thread's arena: no vector may still use it
+    static void release() { arena().release(); }
+
+private:
+    static std::pmr::monotonic_buffer_resource& arena()
+    {
+        thread_local std::pmr::monotonic_buffer_resource resource { 1 << 20 };
+        return resource;
+    }
+};
+
+struct HugePageAllocator
+{
+    static constexpr std::size_t hugePageSize { 2 << 20 };
+
+    static void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (bytes < hugePageSize)
+            return StdAllocator::allocate(bytes, alignment);
+        const std::size_t size { policy_detail::roundUp(bytes, hugePageSize) };
+        // Mapping one more huge page, then cutting both ends, gives a block aligned on a huge page
+        void* mapping { ::mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+        if (mapping == MAP_FAILED)
+            throw std::bad_alloc();
+        auto* start { static_cast<std::byte*>(mapping) };
+        auto* aligned { reinterpret_cast<std::byte*>(policy_detail::roundUp(reinterpret_cast<std::uintptr_t>(start), hugePageSize)) };
+        if (aligned != start)
+            ::munmap(start, static_cast<std::size_t>(aligned - start));
+        if (auto tail { static_cast<std::size_t>(start + size + hugePageSize - (aligned + size)) })
+            ::munmap(aligned + size, tail);
+#ifdef MADV_HUGEPAGE
+        ::madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+        return aligned;
+    }
+
+    static void deallocate(void* p, std::size_t bytes, std::size_t alignment)
+    {
+        if (bytes < hugePageSize)
+            StdAllocator::deallocate(p, bytes, alignment);
+        else
+            ::munmap(p, policy_detail::roundUp(bytes, hugePageSize));
+    }
+};
+
+
+/* BOUNDS POLICIES */
+
+struct BoundsChecked
+{
+    static void check(std::size_t index, std::size_t size)
+    {
+        if (index >= size)
+            throw std::out_of_range("policy_vector: index out of range");
+    }
+};
+
+struct NoBoundsCheck
+{
+    static void check(std::size_t, std::size_t) {}
+};
+
+
+/* STORAGE POLICIES */
+// data(), capacity(), reallocate(capacity, size) moving the 'size' first items to a buffer
+// of at least 'capacity' items, takeFrom(other, size) taking the 'size' items of 'other' (this
+// storage holding no items). Items are built and destroyed by the container, memory is
+// freed by the storage.
+
+template<typename T, typename Allocator>
+class HeapStorage
+{
+public:
+    HeapStorage() = default;
+    HeapStorage(const HeapStorage&) = delete;
+    HeapStorage& operator=(const HeapStorage&) = delete;
+    ~HeapStorage() { release(); }
+
+    T* data() const { return m_data; }
+    std::size_t capacity() const { return m_capacity; }
+
+    void reallocate(std::size_t capacity, std::size_t size)
+    {
+        auto* data { static_cast<T*>(Allocator::allocate(capacity * sizeof(T), alignof(T))) };
+        try {
+            policy_detail::relocate(m_data, size, data);
+        } catch (...) {
+            Allocator::deallocate(data, capacity * sizeof(T), alignof(T));
+            throw;
+        }
+        release();
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    void takeFrom(HeapStorage& other, std::size_t)
+    {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_capacity = std::exchange(other.m_capacity, 0);
+    }
+
+private:
+    void release()
+    {
+        if (m_data)
+            Allocator::deallocate(m_data, m_capacity * sizeof(T), alignof(T));
+        m_data = nullptr;
+        m_capacity = 0;
+    }
+
+    T* m_data { nullptr };
+    std::size_t m_capacity { 0 };
+};
+
+template<typename T, typename Allocator, std::size_t InlineCapacity = 16>
+class InlineStorage
+{
+    static_assert(InlineCapacity > 0, "InlineStorage: inline capacity must not be 0, use HeapStorage instead");
+
+public:
+    InlineStorage() = default;
+    InlineStorage(const InlineStorage&) = delete;
+    InlineStorage& operator=(const InlineStorage&) = delete;
+    ~InlineStorage() { release(); }
+
+    T* data() const { return m_data; }
+    std::size_t capacity() const { return m_capacity; }
+
+    void reallocate(std::size_t capacity, std::size_t size)
+    {
+        if (capacity <= InlineCapacity)
+            return;
+        auto* data { static_cast<T*>(Allocator::allocate(capacity * sizeof(T), alignof(T))) };
+        try {
+            policy_detail::relocate(m_data, size, data);
+        } catch (...) {
+            Allocator::deallocate(data, capacity * sizeof(T), alignof(T));
+            throw;
+        }
+        release();
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    void takeFrom(InlineStorage& other, std::size_t size)
+    {
+        release();
+        if (other.isInline())
+            policy_detail::relocate(other.m_data, size, m_data);
+        else {
+            m_data = std::exchange(other.m_data, other.inlineData());
+            m_capacity = std::exchange(other.m_capacity, InlineCapacity);
+        }
+    }
+
+private:
+    T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+    bool isInline() const { return m_capacity == InlineCapacity; }
+
+    /// Frees the heap block, back to the inline buffer
+    void release()
+    {
+        if (!isInline())
+            Allocator::deallocate(m_data, m_capacity * sizeof(T), alignof(T));
+        m_data = inlineData();
+        m_capacity = InlineCapacity;
+    }
+
+    alignas(T) std::byte m_inline[InlineCapacity * sizeof(T)];
+    T* m_data { inlineData() };
+    std::size_t m_capacity { InlineCapacity };
+};
+
+template<typename T, typename Allocator>
+class MmapStorage
+{
+    static_assert(std::is_trivially_copyable_v<T>, "MmapStorage: items are moved by the kernel, they must be trivially copyable");
+
+public:
+    MmapStorage() = default;
+    MmapStorage(const MmapStorage&) = delete;
+    MmapStorage& operator=(const MmapStorage&) = delete;
+    ~MmapStorage() { release(); }
+
+    T* data() const { return m_data; }
+    std::size_t capacity() const { return m_bytes / sizeof(T); }
+
+    void reallocate(std::size_t capacity, std::size_t size)
+    {
+        const std::size_t bytes { policy_detail::roundUp(capacity * sizeof(T), policy_detail::pageSize()) };
+        void* mapping;
+        if (!m_data)
+            mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        else {
+#ifdef __linux__
+            // Pages keep their content, wherever the kernel puts them
+            mapping = ::mremap(m_data, m_bytes, bytes, MREMAP_MAYMOVE);
+            (void)size;
+#else
+            mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping != MAP_FAILED) {
+                std::memcpy(mapping, m_data, size * sizeof(T));
+                ::munmap(m_data, m_bytes);
+            }
+#endif
+        }
+        if (mapping == MAP_FAILED)
+            throw std::bad_alloc();
+        m_data = static_cast<T*>(mapping);
+        m_bytes = bytes;
+    }
+
+    void takeFrom(MmapStorage& other, std::size_t)
+    {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_bytes = std::exchange(other.m_bytes, 0);
+    }
+
+private:
+    void release()
+    {
+        if (m_data)
+            ::munmap(m_data, m_bytes);
+        m_data = nullptr;
+        m_bytes = 0;
+    }
+
+    T* m_data { nullptr };
+    std::size_t m_bytes { 0 };
+};
+
+
+/* CONTAINER */
+
+template<typename T,
+         template<typename, typename> class Storage = HeapStorage,
+         typename Growth = Growth2x,
+         typename Allocator = StdAllocator,
+         typename Bounds = NoBoundsCheck>
+class policy_vector
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    policy_vector() = default;
+
+    explicit policy_vector(size_type count, const T& value = T())
+    {
+        resize(count, value);
+    }
+
+    policy_vector(std::initializer_list<T> items)
+    {
+        reserve(items.size());
+        std::uninitialized_copy(items.begin(), items.end(), data());
+        m_size = items.size();
+    }
+
+    policy_vector(const policy_vector& other)
+    {
+        reserve(other.size());
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        m_size = other.m_size;
+    }
+
+    policy_vector(policy_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        m_storage.takeFrom(other.m_storage, other.m_size);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    policy_vector& operator=(const policy_vector& other)
+    {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    policy_vector& operator=(policy_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other) {
+            clear();
+            m_storage.takeFrom(other.m_storage, other.m_size);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~policy_vector() { clear(); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + m_size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + m_size; }
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_storage.capacity(); }
+    bool empty() const { return m_size == 0; }
+
+    T* data() { return m_storage.data(); }
+    const T* data() const { return m_storage.data(); }
+
+    T& operator[](size_type i)
+    {
+        Bounds::check(i, m_size);
+        return data()[i];
+    }
+
+    const T& operator[](size_type i) const
+    {
+        Bounds::check(i, m_size);
+        return data()[i];
+    }
+
+    T& at(size_type i)
+    {
+        BoundsChecked::check(i, m_size);
+        return data()[i];
+    }
+
+    const T& at(size_type i) const
+    {
+        BoundsChecked::check(i, m_size);
+        return data()[i];
+    }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[m_size - 1]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    /// Capacity of at least 'capacity' items, exactly (no growth factor)
+    void reserve(size_type capacity)
+    {
+        if (capacity > this->capacity())
+            m_storage.reallocate(capacity, m_size);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (m_size == capacity()) [[unlikely]]
+            return growAndEmplaceBack(std::forward<Args>(args)...);
+        ::new (static_cast<void*>(data() + m_size)) T(std::forward<Args>(args)...);
+        return data()[m_size++];
+    }
+
+    void push_back(const T& item) { emplace_back(item); }
+    void push_back(T&& item) { emplace_back(std::move(item)); }
+
+    void pop_back()
+    {
+        data()[--m_size].~T();
+    }
+
+    void resize(size_type count, const T& value = T())
+    {
+        if (count < m_size)
+            std::destroy(data() + count, data() + m_size);
+        else if (count > capacity()) {
+            // Copied first: value may be an item of the vector, destroyed by the growth
+            const T item(value);
+            reserve(count);
+            std::uninitialized_fill(data() + m_size, data() + count, item);
+        }
+        else
+            std::uninitialized_fill(data() + m_size, data() + count, value);
+        m_size = count;
+    }
+
+    void clear()
+    {
+        std::destroy(data(), data() + m_size);
+        m_size = 0;
+    }
+
+private:
+    /// Slow path of emplace_back, kept out of line so that the fast path stays small
+    template<typename... Args>
+    [[gnu::noinline]] T& growAndEmplaceBack(Args&&... args)
+    {
+        // Item built before moving to a larger buffer: args may refer to an item of the vector
+        T item(std::forward<Args>(args)...);
+        m_storage.reallocate(Growth::next(capacity(), m_size + 1), m_size);
+        ::new (static_cast<void*>(data() + m_size)) T(std::move(item));
+        return data()[m_size++];
+    }
+
+    Storage<T, Allocator> m_storage;
+    size_type m_size { 0 };
+};
+
+
+#endif // POLICYVECTOR_H
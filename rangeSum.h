@@ -0,0 +1,113 @@
+#ifndef RANGESUM_H
+#define RANGESUM_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "simdKernels.h"
+
+
+/*************************************
+ * SUM OF A RANGE
+ * accumulate(first, last, init) adds items one after the other: a single dependency chain
+ * (no vectorization for floating point), and the rounding error of each addition piles up.
+ * With floats, once the total is large, small items are partly or totally lost:
+ * 1e7 times 0.1f gives 1087937 instead of 1000000.
+ *
+ * sum(range) chooses at compile time, from the item type:
+ * - double, float, int32_t, int64_t in contiguous memory: SIMD kernels (simdKernels.h).
+ *   Each lane of several registers is a separate partial sum, partial sums are added at
+ *   the end: faster, and more accurate for floating point (each partial sum is smaller).
+ * - strings: total length computed first, a single allocation, then appends.
+ * - anything else with operator+: accumulate, starting from a value initialized item.
+ *
+ * sum(range, compensated): floating point only, Neumaier's variant of Kahan summation. A
+ * second variable keeps the rounding error of each addition. Summed on the side until the
+ * end, this compensation becomes a long sum of small values that drifts in turn (the 0.1f
+ * example above would still be off by 2000): it is added back to the total after each item,
+ * keeping the rounding error of that addition as the new compensation. Error no longer grows
+ * with the number of items, for several times the cost of a plain loop (no vectorization,
+ * more operations per item).
+ * **********************************/
+
+
+/// Tag asking for compensated summation
+struct compensated_t
+{
+    explicit compensated_t() = default;
+};
+inline constexpr compensated_t compensated {};
+
+
+namespace detail {
+
+/// Adds 'value' to 'total', returns the rounding error of the addition (Neumaier)
+template<typename T>
+T addWithError(T& total, T value)
+{
+    const T next { total + value };
+    // Low order bits lost by the addition: from value if total is larger, from total otherwise
+    const T error { std::abs(total) >= std::abs(value) ? (total - next) + value : (value - next) + total };
+    total = next;
+    return error;
+}
+
+template<typename T>
+struct IsBasicString : std::false_type {};
+
+template<typename Char, typename Traits, typename Allocator>
+struct IsBasicString<std::basic_string<Char, Traits, Allocator>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool hasSimdSum { std::is_same_v<T, double> || std::is_same_v<T, float>
+                                   || std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::int64_t> };
+
+} // namespace detail
+
+
+template<std::ranges::input_range R>
+auto sum(const R& range)
+{
+    using T = std::ranges::range_value_t<R>;
+
+    if constexpr (std::ranges::contiguous_range<R> && detail::hasSimdSum<T>)
+        return simdSum(std::span<const T>(std::ranges::data(range), std::ranges::size(range)));
+    else if constexpr (detail::IsBasicString<T>::value) {
+        T total;
+        if constexpr (std::ranges::forward_range<R>) {
+            std::size_t length { 0 };
+            for (const auto& item : range)
+                length += item.size();
+            total.reserve(length);
+        }
+        for (const auto& item : range)
+            total.append(item);
+        return total;
+    }
+    else
+        return std::accumulate(std::ranges::begin(range), std::ranges::end(range), T {});
+}
+
+template<std::ranges::input_range R>
+    requires std::is_floating_point_v<std::ranges::range_value_t<R>>
+auto sum(const R& range, compensated_t)
+{
+    using T = std::ranges::range_value_t<R>;
+    T total { 0 };
+    T compensation { 0 };   // what total misses, always much smaller than total
+    for (const T item : range) {
+        compensation += detail::addWithError(total, item);
+        compensation = detail::addWithError(total, compensation);
+    }
+    return total + compensation;
+}
+
+
+#endif // RANGESUM_H
@@ -0,0 +1,381 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * RING BUFFER
+ * std::deque stores items in fixed size blocks, plus a map of pointers to the blocks.
+ * Pushing allocates a new block from time to time, popping frees them, and iterating
+ * jumps from block to block.
+ *
+ * ring_buffer stores items in a single contiguous array used as a circle: 'head' is the
+ * index of the first item, item i is at (head + i) modulo capacity. Pushing or popping at
+ * either end only moves 'head' or the size, items stay in place. Capacity is a power of 2
+ * so that the modulo is a simple mask.
+ * Two modes:
+ * - Growable: capacity doubles when full (all items are moved to the new array)
+ * - Bounded: capacity is fixed at construction, no allocation afterwards. Pushing to a full
+ *   buffer throws std::length_error, try_push_back/try_push_front return false instead.
+ * Capacity is given with a tag: ring_buffer<int, RingMode::Bounded> rb(with_capacity, 1024).
+ * As with deque, ring_buffer<int> rb(n) holds n items.
+ *
+ * Interface is the one of deque (push/pop at both ends, random access, insert, erase), so
+ * ring_buffer can also be used under a queue: std::queue<T, ring_buffer<T>>.
+ * As with vector, iterators are invalidated when the buffer grows, or by insert and erase.
+ * **********************************/
+
+
+enum class RingMode { Growable, Bounded };
+
+/// Tag of the constructor taking a capacity (ring_buffer(n) holds n items, as deque(n))
+struct with_capacity_t
+{
+    explicit with_capacity_t() = default;
+};
+inline constexpr with_capacity_t with_capacity {};
+
+template<typename T, RingMode mode = RingMode::Growable>
+class ring_buffer
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    template<bool isConst>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<isConst, const T*, T*>;
+        using reference = std::conditional_t<isConst, const T&, T&>;
+
+        Iterator() = default;
+        Iterator(pointer items, size_type mask, size_type position) : m_items(items), m_mask(mask), m_position(position) {}
+        // iterator -> const_iterator
+        operator Iterator<true>() const { return { m_items, m_mask, m_position }; }
+
+        reference operator*() const { return m_items[m_position & m_mask]; }
+        pointer operator->() const { return &m_items[m_position & m_mask]; }
+        reference operator[](difference_type n) const { return m_items[(m_position + n) & m_mask]; }
+
+        Iterator& operator++() { ++m_position; return *this; }
+        Iterator& operator--() { --m_position; return *this; }
+        Iterator operator++(int) { auto previous { *this }; ++m_position; return previous; }
+        Iterator operator--(int) { auto previous { *this }; --m_position; return previous; }
+        Iterator& operator+=(difference_type n) { m_position += n; return *this; }
+        Iterator& operator-=(difference_type n) { m_position -= n; return *this; }
+        friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+        friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+        friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const Iterator& a, const Iterator& b)
+        {
+            return static_cast<difference_type>(a.m_position - b.m_position);
+        }
+        bool operator==(const Iterator& other) const { return m_position == other.m_position; }
+        auto operator<=>(const Iterator& other) const { return *this - other <=> 0; }
+
+    private:
+        // Iterator doesn't go through the ring_buffer object: array and mask are copied
+        pointer m_items { nullptr };
+        size_type m_mask { 0 };
+        size_type m_position { 0 };   // head + index, not wrapped: always increasing along the items
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ring_buffer() : ring_buffer(with_capacity, 16) {}
+
+    /// 'capacity' is rounded up to a power of 2. Bounded mode: it never changes.
+    ring_buffer(with_capacity_t, size_type capacity)
+    {
+        allocate(capacity);
+    }
+
+    /// 'count' value-initialized items
+    explicit ring_buffer(size_type count) : ring_buffer(with_capacity, count)
+    {
+        for (size_type i { 0 }; i < count; i++)
+            emplace_back();
+    }
+
+    ring_buffer(size_type count, const T& value) : ring_buffer(with_capacity, count)
+    {
+        for (size_type i { 0 }; i < count; i++)
+            push_back(value);
+    }
+
+    ring_buffer(std::initializer_list<T> items) : ring_buffer(with_capacity, items.size())
+    {
+        for (const auto& item : items)
+            push_back(item);
+    }
+
+    ring_buffer(const ring_buffer& other) : ring_buffer(with_capacity, other.capacity())
+    {
+        for (const auto& item : other)
+            push_back(item);
+    }
+
+    ring_buffer(ring_buffer&& other) noexcept
+    {
+        swap(other);
+    }
+
+    ring_buffer& operator=(ring_buffer other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~ring_buffer()
+    {
+        clear();
+        std::allocator<T>().deallocate(m_items, m_mask + 1);
+    }
+
+    void swap(ring_buffer& other) noexcept
+    {
+        std::swap(m_items, other.m_items);
+        std::swap(m_mask, other.m_mask);
+        std::swap(m_head, other.m_head);
+        std::swap(m_size, other.m_size);
+    }
+
+    iterator begin() { return { m_items, m_mask, m_head }; }
+    iterator end() { return { m_items, m_mask, m_head + m_size }; }
+    const_iterator begin() const { return { m_items, m_mask, m_head }; }
+    const_iterator end() const { return { m_items, m_mask, m_head + m_size }; }
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_items ? m_mask + 1 : 0; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == capacity(); }
+
+    T& operator[](size_type i) { return m_items[(m_head + i) & m_mask]; }
+    const T& operator[](size_type i) const { return m_items[(m_head + i) & m_mask]; }
+    T& front() { return m_items[m_head]; }
+    const T& front() const { return m_items[m_head]; }
+    T& back() { return (*this)[m_size - 1]; }
+    const T& back() const { return (*this)[m_size - 1]; }
+
+    T& at(size_type i)
+    {
+        if (i >= m_size)
+            throw std::out_of_range("ring_buffer::at: index out of range");
+        return (*this)[i];
+    }
+
+    const T& at(size_type i) const
+    {
+        return const_cast<ring_buffer*>(this)->at(i);
+    }
+
+    /**
+     * @brief Items as two contiguous parts: from head to the end of the array, then the
+     * items that wrapped around to the beginning of the array (possibly empty).
+     * Loops over plain arrays are faster than going through iterators (no mask, vectorizable).
+     */
+    std::pair<std::span<T>, std::span<T>> segments()
+    {
+        const size_type first { std::min(m_size, capacity() - m_head) };
+        return { { m_items + m_head, first }, { m_items, m_size - first } };
+    }
+
+    std::pair<std::span<const T>, std::span<const T>> segments() const
+    {
+        const size_type first { std::min(m_size, capacity() - m_head) };
+        return { { m_items + m_head, first }, { m_items, m_size - first } };
+    }
+
+    /// Growable mode only: makes room for 'capacity' items
+    void reserve(size_type capacity)
+    {
+        static_assert(mode == RingMode::Growable, "ring_buffer: a bounded buffer can't be resized");
+        if (capacity > this->capacity())
+            reallocate(capacity);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (full()) [[unlikely]]
+            return growAndEmplace<false>(std::forward<Args>(args)...);
+        T* slot { &m_items[(m_head + m_size) & m_mask] };
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        m_size++;
+        return *slot;
+    }
+
+    template<typename... Args>
+    T& emplace_front(Args&&... args)
+    {
+        if (full()) [[unlikely]]
+            return growAndEmplace<true>(std::forward<Args>(args)...);
+        const size_type head { (m_head - 1) & m_mask };
+        ::new (static_cast<void*>(&m_items[head])) T(std::forward<Args>(args)...);
+        m_head = head;
+        m_size++;
+        return m_items[head];
+    }
+
+    void push_back(const T& item) { emplace_back(item); }
+    void push_back(T&& item) { emplace_back(std::move(item)); }
+    void push_front(const T& item) { emplace_front(item); }
+    void push_front(T&& item) { emplace_front(std::move(item)); }
+
+    /// Same as push_back, but returns false instead of throwing when a bounded buffer is full
+    bool try_push_back(const T& item)
+    {
+        if (mode == RingMode::Bounded && full())
+            return false;
+        emplace_back(item);
+        return true;
+    }
+
+    bool try_push_front(const T& item)
+    {
+        if (mode == RingMode::Bounded && full())
+            return false;
+        emplace_front(item);
+        return true;
+    }
+
+    void pop_front()
+    {
+        m_items[m_head].~T();
+        m_head = (m_head + 1) & m_mask;
+        m_size--;
+    }
+
+    void pop_back()
+    {
+        back().~T();
+        m_size--;
+    }
+
+    iterator insert(const_iterator position, const T& item) { return emplace(position, item); }
+    iterator insert(const_iterator position, T&& item) { return emplace(position, std::move(item)); }
+
+    /// Items are shifted towards the closest end
+    template<typename... Args>
+    iterator emplace(const_iterator position, Args&&... args)
+    {
+        const auto index { static_cast<size_type>(position - cbegin()) };
+        if (index < m_size / 2) {
+            emplace_front(std::forward<Args>(args)...);
+            std::rotate(begin(), begin() + 1, begin() + static_cast<difference_type>(index) + 1);
+        }
+        else {
+            emplace_back(std::forward<Args>(args)...);
+            std::rotate(begin() + static_cast<difference_type>(index), end() - 1, end());
+        }
+        return begin() + static_cast<difference_type>(index);
+    }
+
+    /// Items are shifted from the closest end
+    iterator erase(const_iterator position)
+    {
+        const auto index { static_cast<difference_type>(position - cbegin()) };
+        if (static_cast<size_type>(index) < m_size / 2) {
+            std::move_backward(begin(), begin() + index, begin() + index + 1);
+            pop_front();
+        }
+        else {
+            std::move(begin() + index + 1, end(), begin() + index);
+            pop_back();
+        }
+        return begin() + index;
+    }
+
+    void clear()
+    {
+        while (m_size)
+            pop_back();
+        m_head = 0;
+    }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool operator==(const ring_buffer& other) const
+    {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    static size_type roundUp(size_type capacity)
+    {
+        size_type rounded { 1 };
+        while (rounded < capacity)
+            rounded *= 2;
+        return rounded;
+    }
+
+    void allocate(size_type capacity)
+    {
+        capacity = roundUp(std::max<size_type>(capacity, 1));
+        m_items = std::allocator<T>().allocate(capacity);
+        m_mask = capacity - 1;
+    }
+
+    /// Slow path of emplace_back/emplace_front on a full buffer, kept out of line so that the fast path stays small
+    template<bool front, typename... Args>
+    [[gnu::noinline]] T& growAndEmplace(Args&&... args)
+    {
+        if constexpr (mode == RingMode::Bounded)
+            throw std::length_error("ring_buffer: bounded buffer is full");
+        else {
+            // Item built before moving to a larger array: args may refer to an item of the buffer
+            T item(std::forward<Args>(args)...);
+            reallocate(capacity() * 2);
+            if constexpr (front)
+                return emplace_front(std::move(item));
+            else
+                return emplace_back(std::move(item));
+        }
+    }
+
+    /// Moves items to a new array, first item at index 0
+    [[gnu::noinline]] void reallocate(size_type capacity)
+    {
+        ring_buffer bigger(with_capacity, capacity);
+        for (size_type i { 0 }; i < m_size; i++)
+            ::new (static_cast<void*>(&bigger.m_items[i])) T(std::move((*this)[i]));
+        bigger.m_size = m_size;
+        swap(bigger);
+    }
+
+    T* m_items { nullptr };
+    size_type m_mask { 0 };     // capacity - 1
+    size_type m_head { 0 };     // index of the first item in the array
+    size_type m_size { 0 };
+};
+
+
+// enable operator<<
+template<typename T, RingMode mode>
+struct is_type_container<ring_buffer<T, mode>> {
+  static const bool value = true;
+};
+
+
+#endif // RINGBUFFER_H
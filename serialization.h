@@ -0,0 +1,324 @@
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * BINARY SERIALIZATION
+ * Same traits as operator<< (is_type_container, is_type_map, is_type_adaptor) select
+ * how a value is written:
+ * - arithmetic and other trivially copyable values: raw bytes
+ * - strings: length (uint64) followed by the characters
+ * - vector and array of trivially copyable items: count (uint64) followed by all
+ *   items in a single write. Reading back is done by large chunks (1 MB), or with no
+ *   read at all with binaryView() on a memory mapped file.
+ * - any other container (deque, list, set, map, queue, nested containers, array of strings):
+ *   count (uint64) followed by each item, serialized recursively. Trivially copyable
+ *   items are gathered in chunks so that the stream sees large writes only. Arrays are
+ *   read back in place, their count must match.
+ *
+ * Format uses the native byte order and type sizes: it is meant for snapshots
+ * restored on the same kind of machine, not for data exchange.
+ * Errors (stream failure, truncated data, size mismatch) are raised as std::runtime_error.
+ * Counts read from the stream are not trusted for allocations: strings and vectors grow by
+ * chunks as data is read, so a corrupt count fails as truncated data.
+ * **********************************/
+
+
+// Containers that can be written and read in bulk: contiguous storage of trivially copyable items.
+// vector<bool> is not contiguous and is excluded.
+template<typename T>
+struct is_type_bulk {
+  static const bool value = false;
+};
+
+template<typename T, typename A>
+struct is_type_bulk<std::vector<T, A>> {
+  static const bool value = std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value;
+};
+
+template<typename T, std::size_t n>
+struct is_type_bulk<std::array<T, n>> {
+  static const bool value = std::is_trivially_copyable<T>::value;
+};
+
+// Containers of fixed size: read back in place, the count must match.
+template<typename T>
+struct is_type_fixed_size {
+  static const bool value = false;
+};
+
+template<typename T, std::size_t n>
+struct is_type_fixed_size<std::array<T, n>> {
+  static const bool value = true;
+};
+
+
+namespace detail {
+
+// Items of node based containers are written and read by chunks of that many items
+inline constexpr std::size_t chunkSize { 4096 };
+// Strings and vectors are read by chunks of that many bytes
+inline constexpr std::size_t bulkChunkBytes { 1 << 20 };
+
+inline void writeBytes(std::ostream& os, const void* data, std::size_t size)
+{
+    if (!os.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)))
+        throw std::runtime_error("serialize: write failed");
+}
+
+inline void readBytes(std::istream& is, void* data, std::size_t size)
+{
+    if (!is.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+        throw std::runtime_error("deserialize: truncated data");
+}
+
+inline void writeCount(std::ostream& os, std::size_t count)
+{
+    const std::uint64_t value { count };
+    writeBytes(os, &value, sizeof(value));
+}
+
+inline std::size_t readCount(std::istream& is)
+{
+    std::uint64_t value;
+    readBytes(is, &value, sizeof(value));
+    return static_cast<std::size_t>(value);
+}
+
+/**
+ * @brief Reads 'count' items into a string or vector, growing it by bounded chunks.
+ * The count comes from the stream: if it is corrupt, reading fails on truncated data
+ * instead of allocating the whole size up front.
+ */
+template<typename C>
+void readResizable(std::istream& is, C& value, std::size_t count)
+{
+    using Item = typename C::value_type;
+    constexpr std::size_t step { std::max<std::size_t>(1, bulkChunkBytes / sizeof(Item)) };
+    value.clear();
+    for (std::size_t done { 0 }; done < count;) {
+        const std::size_t n { std::min(count - done, step) };
+        value.resize(done + n);
+        readBytes(is, value.data() + done, n * sizeof(Item));
+        done += n;
+    }
+}
+
+} // namespace detail
+
+
+template<typename T>
+void serialize(std::ostream& os, const T& value);
+
+template<typename T>
+void deserialize(std::istream& is, T& value);
+
+
+template<typename T>
+void serialize(std::ostream& os, const T& value)
+{
+    if constexpr (std::is_same<T, std::string>::value) {
+        detail::writeCount(os, value.size());
+        detail::writeBytes(os, value.data(), value.size());
+    }
+    else if constexpr (is_type_bulk<T>::value) {
+        detail::writeCount(os, value.size());
+        detail::writeBytes(os, value.data(), value.size() * sizeof(typename T::value_type));
+    }
+    else if constexpr (is_type_map<T>::value) {
+        detail::writeCount(os, value.size());
+        for (const auto& [key, item] : value) {
+            serialize(os, key);
+            serialize(os, item);
+        }
+    }
+    else if constexpr (is_type_container<T>::value) {
+        detail::writeCount(os, value.size());
+        if constexpr (std::is_trivially_copyable<typename T::value_type>::value) {
+            // Items are gathered by chunks: one write per chunk instead of one per item
+            std::vector<typename T::value_type> chunk;
+            chunk.reserve(std::min(value.size(), detail::chunkSize));
+            for (const auto& item : value) {
+                chunk.push_back(item);
+                if (chunk.size() == detail::chunkSize) {
+                    detail::writeBytes(os, chunk.data(), chunk.size() * sizeof(item));
+                    chunk.clear();
+                }
+            }
+            detail::writeBytes(os, chunk.data(), chunk.size() * sizeof(typename T::value_type));
+        }
+        else {
+            for (const auto& item : value)
+                serialize(os, item);
+        }
+    }
+    else if constexpr (is_type_adaptor<T>::value)
+        // Wrapped container is written as is: same layout for queue, stack and priority_queue (heap order)
+        serialize(os, underlyingContainer(value));
+    else {
+        static_assert(std::is_trivially_copyable<T>::value, "serialize: unsupported type");
+        detail::writeBytes(os, &value, sizeof(value));
+    }
+}
+
+template<typename T>
+void deserialize(std::istream& is, T& value)
+{
+    if constexpr (std::is_same<T, std::string>::value)
+        detail::readResizable(is, value, detail::readCount(is));
+    else if constexpr (is_type_bulk<T>::value) {
+        const auto count { detail::readCount(is) };
+        if constexpr (requires { value.resize(count); })
+            detail::readResizable(is, value, count);
+        else {
+            if (count != value.size())
+                throw std::runtime_error("deserialize: array size mismatch");
+            detail::readBytes(is, value.data(), count * sizeof(typename T::value_type));
+        }
+    }
+    else if constexpr (is_type_map<T>::value) {
+        value.clear();
+        const auto count { detail::readCount(is) };
+        for (std::size_t i { 0 }; i < count; i++) {
+            typename T::key_type key;
+            typename T::mapped_type item;
+            deserialize(is, key);
+            deserialize(is, item);
+            value.emplace_hint(value.end(), std::move(key), std::move(item));
+        }
+    }
+    else if constexpr (is_type_fixed_size<T>::value) {
+        if (detail::readCount(is) != value.size())
+            throw std::runtime_error("deserialize: array size mismatch");
+        for (auto& item : value)
+            deserialize(is, item);
+    }
+    else if constexpr (is_type_container<T>::value) {
+        value.clear();
+        const auto count { detail::readCount(is) };
+        // Count is not trusted for the pre-allocation: at most a chunk, items read may go further
+        if constexpr (requires { value.reserve(count); })
+            value.reserve(std::min(count, detail::chunkSize));
+        if constexpr (std::is_trivially_copyable<typename T::value_type>::value) {
+            std::vector<typename T::value_type> chunk(std::min(count, detail::chunkSize));
+            for (std::size_t done { 0 }; done < count; done += chunk.size()) {
+                chunk.resize(std::min(count - done, detail::chunkSize));
+                detail::readBytes(is, chunk.data(), chunk.size() * sizeof(typename T::value_type));
+                for (const auto& item : chunk)
+                    value.insert(value.end(), item);
+            }
+        }
+        else {
+            for (std::size_t i { 0 }; i < count; i++) {
+                typename T::value_type item;
+                deserialize(is, item);
+                value.insert(value.end(), std::move(item));
+            }
+        }
+    }
+    else if constexpr (is_type_adaptor<T>::value) {
+        typename T::container_type container;
+        deserialize(is, container);
+        // priority_queue is rebuilt with its comparator, heap order is kept
+        if constexpr (requires { typename T::value_compare; })
+            value = T(typename T::value_compare(), std::move(container));
+        else
+            value = T(std::move(container));
+    }
+    else {
+        static_assert(std::is_trivially_copyable<T>::value, "deserialize: unsupported type");
+        detail::readBytes(is, &value, sizeof(value));
+    }
+}
+
+
+/**
+ * @brief Read only view over a vector or array serialized at the beginning of 'data'.
+ * No copy: the returned span points into 'data', which must outlive it.
+ * Used on a MappedFile, restoring a snapshot costs nothing until items are accessed.
+ */
+template<typename T>
+std::span<const T> binaryView(std::span<const std::byte> data)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "binaryView: items must be trivially copyable");
+    std::uint64_t count;
+    if (data.size() < sizeof(count))
+        throw std::runtime_error("binaryView: truncated data");
+    std::memcpy(&count, data.data(), sizeof(count));
+    const auto items { data.subspan(sizeof(count)) };
+    if (items.size() / sizeof(T) < count)
+        throw std::runtime_error("binaryView: truncated data");
+    if (reinterpret_cast<std::uintptr_t>(items.data()) % alignof(T))
+        throw std::runtime_error("binaryView: misaligned data");
+    return { reinterpret_cast<const T*>(items.data()), static_cast<std::size_t>(count) };
+}
+
+
+/**
+ * @brief Read only memory mapping of a whole file (RAII: unmapped on destruction).
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+        const int fd { ::open(path.c_str(), O_RDONLY) };
+        if (fd < 0)
+            throw std::runtime_error("MappedFile: cannot open " + path + ": " + std::strerror(errno));
+        struct stat info;
+        if (::fstat(fd, &info) < 0) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: cannot stat " + path + ": " + std::strerror(errno));
+        }
+        m_size = static_cast<std::size_t>(info.st_size);
+        if (m_size) {
+            m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m_data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("MappedFile: cannot map " + path + ": " + std::strerror(errno));
+            }
+        }
+        // Mapping remains valid once the file is closed
+        ::close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (m_size)
+            ::munmap(m_data, m_size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> data() const
+    {
+        return { static_cast<const std::byte*>(m_data), m_size };
+    }
+
+private:
+    void* m_data { nullptr };
+    std::size_t m_size { 0 };
+};
+
+
+#endif // SERIALIZATION_H
@@ -0,0 +1,118 @@
+#ifndef SHAREDCOUNTERS_H
+#define SHAREDCOUNTERS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*************************************
+ * COUNTERS SHARED BY SEVERAL THREADS
+ * A plain int incremented by several threads loses updates (a++ is read, add, write).
+ * Three thread safe counters with the same interface (add, ++, --, value):
+ * - MutexCounter: each update locks a mutex. Simple, but threads wait for each other.
+ * - AtomicCounter: single std::atomic updated with relaxed ordering (only the count
+ *   matters, it doesn't publish other data). No lock, but all threads write the same cache
+ *   line, which goes back and forth between cores: it doesn't scale with threads.
+ * - ShardedCounter: one atomic per 'shard', each thread updates its own shard and value()
+ *   sums all shards. Updates scale, reading is slower (and not a snapshot: updates made
+ *   meanwhile may or may not be counted). Fits statistics updated often and read rarely.
+ *
+ * FALSE SHARING
+ * Cores exchange memory by cache lines (64 bytes on x86 and most ARM). Two shards in the
+ * same line are as slow as a single atomic, even though threads never touch the same
+ * variable. Shards are aligned on a cache line each: 'Alignment' parameter only exists
+ * to show the effect (ShardedCounter<sizeof(long)> packs shards together).
+ * **********************************/
+
+
+/// Cache line size. std::hardware_destructive_interference_size is not stable across compiler flags.
+constexpr std::size_t cacheLineSize { 64 };
+
+
+class MutexCounter
+{
+public:
+    void add(long delta)
+    {
+        std::lock_guard lock { m_mutex };
+        m_value += delta;
+    }
+
+    MutexCounter& operator++() { add(1); return *this; }
+    MutexCounter& operator--() { add(-1); return *this; }
+
+    long value() const
+    {
+        std::lock_guard lock { m_mutex };
+        return m_value;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    long m_value { 0 };
+};
+
+
+class AtomicCounter
+{
+public:
+    void add(long delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+
+    AtomicCounter& operator++() { add(1); return *this; }
+    AtomicCounter& operator--() { add(-1); return *this; }
+
+    long value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<long> m_value { 0 };
+};
+
+
+template<std::size_t Alignment = cacheLineSize>
+class ShardedCounter
+{
+public:
+    /// One shard per core by default. Threads beyond that share shards.
+    explicit ShardedCounter(std::size_t shards = std::thread::hardware_concurrency())
+        : m_shards(std::max<std::size_t>(1, shards))
+    {}
+
+    void add(long delta)
+    {
+        m_shards[threadIndex() % m_shards.size()].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    ShardedCounter& operator++() { add(1); return *this; }
+    ShardedCounter& operator--() { add(-1); return *this; }
+
+    long value() const
+    {
+        long total { 0 };
+        for (const auto& shard : m_shards)
+            total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    struct alignas(Alignment) Shard
+    {
+        std::atomic<long> value { 0 };
+    };
+
+    /// 0 for the first thread calling it, 1 for the next one... (shared by all counters of this type)
+    static std::size_t threadIndex()
+    {
+        static std::atomic<std::size_t> nextIndex { 0 };
+        thread_local const std::size_t index { nextIndex.fetch_add(1, std::memory_order_relaxed) };
+        return index;
+    }
+
+    std::vector<Shard> m_shards;
+};
+
+
+#endif // SHAREDCOUNTERS_H
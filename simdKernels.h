@@ -0,0 +1,312 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+
+/*************************************
+ * SIMD REDUCTION KERNELS
+ * A loop such as accumulate can't be vectorized by the compiler for floating point
+ * values: additions must be done in order, one after the other.
+ * Kernels below process several items at once (one SIMD register) and keep several
+ * registers in flight to hide operation latency. Items are thus combined in a different
+ * order: with floating point values, sum and product may slightly differ from accumulate.
+ *
+ * Each kernel is compiled several times, once per instruction set (SSE2, AVX2, AVX-512)
+ * thanks to the 'target' attribute of GCC/clang. The best instruction set supported by
+ * the CPU is detected at run time (CPUID, through __builtin_cpu_supports) and the
+ * matching version is used. Other CPUs (or compilers) use a plain scalar loop.
+ *
+ * Code is written with GCC vector extensions: 'T __attribute__((vector_size(N)))' is a
+ * SIMD register of N bytes holding N/sizeof(T) items, on which regular operators work.
+ *
+ * Supported types: double, float, int32_t and int64_t.
+ * Empty ranges: sum=0, product=1, min=+max value, max=lowest value, argmax=0.
+ * As with max_element, argmax returns the index of the first greatest item.
+ * **********************************/
+
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_KERNELS_X86 1
+#else
+#define SIMD_KERNELS_X86 0
+#endif
+
+
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+inline const char* toString(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::SSE2: return "SSE2";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::AVX512: return "AVX-512";
+    default: return "scalar";
+    }
+}
+
+/// Best instruction set supported by the CPU running the program
+inline SimdLevel detectSimdLevel()
+{
+#if SIMD_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+
+namespace simd_detail {
+
+// Operations work on single items as well as on SIMD registers.
+// Registers are passed by reference: passing them by value would depend on the target ABI.
+struct Plus {
+    template<typename V> [[gnu::always_inline]] void operator()(V& acc, const V& v) const { acc += v; }
+};
+struct Multiplies {
+    template<typename V> [[gnu::always_inline]] void operator()(V& acc, const V& v) const { acc *= v; }
+};
+struct Min {
+    template<typename V> [[gnu::always_inline]] void operator()(V& acc, const V& v) const { acc = v < acc ? v : acc; }
+};
+struct Max {
+    template<typename V> [[gnu::always_inline]] void operator()(V& acc, const V& v) const { acc = acc < v ? v : acc; }
+};
+
+// Number of registers used in parallel by a kernel
+inline constexpr std::size_t unroll { 4 };
+
+/// Reduces 'n' items with 'op', 'width' bytes at a time
+template<std::size_t width, typename T, typename Op>
+[[gnu::always_inline]] inline T reduce(const T* data, std::size_t n, T identity, Op op)
+{
+    typedef T V __attribute__((vector_size(width)));
+    constexpr std::size_t lanes { width / sizeof(T) };
+
+    V acc[unroll];
+    for (auto& a : acc)
+        for (std::size_t lane { 0 }; lane < lanes; lane++)
+            a[lane] = identity;
+
+    std::size_t i { 0 };
+    for (; i + unroll * lanes <= n; i += unroll * lanes) {
+        for (std::size_t k { 0 }; k < unroll; k++) {
+            V v;
+            std::memcpy(&v, data + i + k * lanes, sizeof(V));   // unaligned load
+            op(acc[k], v);
+        }
+    }
+    for (; i + lanes <= n; i += lanes) {
+        V v;
+        std::memcpy(&v, data + i, sizeof(V));
+        op(acc[0], v);
+    }
+    for (std::size_t k { 1 }; k < unroll; k++)
+        op(acc[0], acc[k]);
+
+    T result { identity };
+    for (std::size_t lane { 0 }; lane < lanes; lane++)
+        op(result, T(acc[0][lane]));
+    for (; i < n; i++)
+        op(result, data[i]);
+    return result;
+}
+
+/**
+ * @brief Index of the first greatest item, 'width' bytes at a time.
+ * Each lane keeps its greatest value and where it was found. Lanes are merged at the end.
+ * Index lanes have the same size as items: 32 bits indexes for float and int32, that's why
+ * the range is processed by blocks small enough to be indexed.
+ */
+template<std::size_t width, typename T>
+[[gnu::always_inline]] inline std::size_t argmax(const T* data, std::size_t n)
+{
+    typedef T V __attribute__((vector_size(width)));
+    using Index = std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>;
+    typedef Index I __attribute__((vector_size(width)));
+    constexpr std::size_t lanes { width / sizeof(T) };
+    constexpr std::size_t blockSize { (std::size_t { 1 } << (sizeof(T) == 4 ? 30 : 62)) };
+
+    if (n == 0)
+        return 0;
+    std::size_t best { 0 };
+    for (std::size_t offset { 0 }; offset < n; offset += blockSize) {
+        const T* block { data + offset };
+        const std::size_t count { n - offset < blockSize ? n - offset : blockSize };
+
+        std::size_t i { 0 };
+        std::size_t blockBest { 0 };
+        if (count >= lanes) {
+            V maxValues;
+            std::memcpy(&maxValues, block, sizeof(V));
+            I maxIndexes;
+            I indexes;
+            for (std::size_t lane { 0 }; lane < lanes; lane++)
+                indexes[lane] = static_cast<Index>(lane);
+            maxIndexes = indexes;
+            const I step = indexes - indexes + static_cast<Index>(lanes);
+            for (i = lanes; i + lanes <= count; i += lanes) {
+                V v;
+                std::memcpy(&v, block + i, sizeof(V));
+                indexes += step;
+                const auto greater { maxValues < v };     // strictly: first occurrence is kept
+                maxValues = greater ? v : maxValues;
+                maxIndexes = greater ? indexes : maxIndexes;
+            }
+            blockBest = static_cast<std::size_t>(maxIndexes[0]);
+            for (std::size_t lane { 1 }; lane < lanes; lane++) {
+                const T value { maxValues[lane] };
+                const auto index { static_cast<std::size_t>(maxIndexes[lane]) };
+                if (block[blockBest] < value || (!(value < block[blockBest]) && index < blockBest))
+                    blockBest = index;
+            }
+        }
+        for (; i < count; i++)
+            if (block[blockBest] < block[i])
+                blockBest = i;
+        if (offset == 0 || data[best] < block[blockBest])
+            best = offset + blockBest;
+    }
+    return best;
+}
+
+template<typename T>
+std::size_t argmaxScalar(const T* data, std::size_t n)
+{
+    std::size_t best { 0 };
+    for (std::size_t i { 1 }; i < n; i++)
+        if (data[best] < data[i])
+            best = i;
+    return best;
+}
+
+} // namespace simd_detail
+
+
+/// Set of kernels for one type and one instruction set
+template<typename T>
+struct SimdKernels {
+    T (*sum)(const T*, std::size_t);
+    T (*product)(const T*, std::size_t);
+    T (*min)(const T*, std::size_t);
+    T (*max)(const T*, std::size_t);
+    std::size_t (*argmax)(const T*, std::size_t);
+};
+
+namespace simd_detail {
+
+// Identity values of each operation
+template<typename T> constexpr T minIdentity() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+template<typename T> constexpr T maxIdentity() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+
+// One set of kernels per instruction set. Same code, compiled for a different target.
+#define SIMD_KERNELS_FOR(name, targetName, width)                                                                                             \
+    template<typename T> [[gnu::target(targetName)]] T sum##name(const T* d, std::size_t n) { return reduce<width>(d, n, T(0), Plus {}); }      \
+    template<typename T> [[gnu::target(targetName)]] T product##name(const T* d, std::size_t n) { return reduce<width>(d, n, T(1), Multiplies {}); } \
+    template<typename T> [[gnu::target(targetName)]] T min##name(const T* d, std::size_t n) { return reduce<width>(d, n, minIdentity<T>(), Min {}); } \
+    template<typename T> [[gnu::target(targetName)]] T max##name(const T* d, std::size_t n) { return reduce<width>(d, n, maxIdentity<T>(), Max {}); } \
+    template<typename T> [[gnu::target(targetName)]] std::size_t argmax##name(const T* d, std::size_t n) { return argmax<width>(d, n); }         \
+    template<typename T> SimdKernels<T> kernels##name() { return { sum##name<T>, product##name<T>, min##name<T>, max##name<T>, argmax##name<T> }; }
+
+#if SIMD_KERNELS_X86
+SIMD_KERNELS_FOR(SSE2, "sse2", 16)
+SIMD_KERNELS_FOR(AVX2, "avx2", 32)
+SIMD_KERNELS_FOR(AVX512, "avx512f", 64)
+#endif
+
+#undef SIMD_KERNELS_FOR
+
+// Plain loops, also used as reference
+template<typename T>
+T sumScalar(const T* d, std::size_t n)
+{
+    T result { 0 };
+    for (std::size_t i { 0 }; i < n; i++)
+        result += d[i];
+    return result;
+}
+
+template<typename T>
+T productScalar(const T* d, std::size_t n)
+{
+    T result { 1 };
+    for (std::size_t i { 0 }; i < n; i++)
+        result *= d[i];
+    return result;
+}
+
+template<typename T>
+T minScalar(const T* d, std::size_t n)
+{
+    T result { minIdentity<T>() };
+    for (std::size_t i { 0 }; i < n; i++)
+        Min {}(result, d[i]);
+    return result;
+}
+
+template<typename T>
+T maxScalar(const T* d, std::size_t n)
+{
+    T result { maxIdentity<T>() };
+    for (std::size_t i { 0 }; i < n; i++)
+        Max {}(result, d[i]);
+    return result;
+}
+
+} // namespace simd_detail
+
+
+/// Kernels for a given instruction set. CPU support is not checked: see detectSimdLevel()
+template<typename T>
+SimdKernels<T> simdKernels(SimdLevel level)
+{
+    static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value
+                  || std::is_same<T, std::int32_t>::value || std::is_same<T, std::int64_t>::value,
+                  "SIMD kernels only support double, float, int32_t and int64_t");
+    using namespace simd_detail;
+    switch (level) {
+#if SIMD_KERNELS_X86
+    case SimdLevel::AVX512: return kernelsAVX512<T>();
+    case SimdLevel::AVX2: return kernelsAVX2<T>();
+    case SimdLevel::SSE2: return kernelsSSE2<T>();
+#endif
+    default: return { sumScalar<T>, productScalar<T>, minScalar<T>, maxScalar<T>, argmaxScalar<T> };
+    }
+}
+
+/// Kernels for the best instruction set of the CPU, detected once
+template<typename T>
+const SimdKernels<T>& bestSimdKernels()
+{
+    static const SimdKernels<T> kernels { simdKernels<T>(detectSimdLevel()) };
+    return kernels;
+}
+
+
+template<typename T>
+T simdSum(std::span<const T> data) { return bestSimdKernels<T>().sum(data.data(), data.size()); }
+
+template<typename T>
+T simdProduct(std::span<const T> data) { return bestSimdKernels<T>().product(data.data(), data.size()); }
+
+template<typename T>
+T simdMin(std::span<const T> data) { return bestSimdKernels<T>().min(data.data(), data.size()); }
+
+template<typename T>
+T simdMax(std::span<const T> data) { return bestSimdKernels<T>().max(data.data(), data.size()); }
+
+template<typename T>
+std::size_t simdArgmax(std::span<const T> data) { return bestSimdKernels<T>().argmax(data.data(), data.size()); }
+
+
+#endif // SIMDKERNELS_H
@@ -0,0 +1,324 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "metaprogramming.h"
+
+
+/*************************************
+ * SMALL VECTOR
+ * array: items stored inside the object (possibly on the stack), size fixed at compile time.
+ * vector: any size, but items always on the heap: at least one allocation, even for 3 items.
+ *
+ * small_vector<T, N> stores up to N items inside the object, as an array does, and moves
+ * them to the heap only when it grows beyond N. Collections that are usually small never
+ * allocate, large ones still work.
+ * Interface is the same as vector (push_back, emplace_back, insert, erase, resize...).
+ * - object is larger than a vector (N items + size + capacity)
+ * - moving a small_vector that fits inline moves each item instead of a pointer
+ * - as with vector, iterators are invalidated when items are moved (to the heap,
+ *   or by insert and erase)
+ * **********************************/
+
+
+template<typename T, std::size_t N>
+class small_vector
+{
+    static_assert(N > 0, "small_vector: inline capacity must not be 0, use vector instead");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() = default;
+
+    explicit small_vector(size_type count, const T& value = T())
+    {
+        assign(count, value);
+    }
+
+    small_vector(std::initializer_list<T> items)
+    {
+        reserve(items.size());
+        for (const auto& item : items)
+            push_back(item);
+    }
+
+    small_vector(const small_vector& other)
+    {
+        reserve(other.size());
+        std::uninitialized_copy(other.begin(), other.end(), m_data);
+        m_size = other.m_size;
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        moveFrom(other);
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), m_data);
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        if (this != &other) {
+            clear();
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~small_vector()
+    {
+        clear();
+        release();
+    }
+
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+    /// True while items are stored inside the object (no allocation)
+    bool is_inline() const { return m_data == inlineData(); }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    T& operator[](size_type i) { return m_data[i]; }
+    const T& operator[](size_type i) const { return m_data[i]; }
+    T& front() { return m_data[0]; }
+    const T& front() const { return m_data[0]; }
+    T& back() { return m_data[m_size - 1]; }
+    const T& back() const { return m_data[m_size - 1]; }
+
+    T& at(size_type i)
+    {
+        if (i >= m_size)
+            throw std::out_of_range("small_vector::at: index out of range");
+        return m_data[i];
+    }
+
+    const T& at(size_type i) const
+    {
+        return const_cast<small_vector*>(this)->at(i);
+    }
+
+    void reserve(size_type capacity)
+    {
+        if (capacity > m_capacity)
+            reallocate(capacity);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (m_size == m_capacity) [[unlikely]]
+            return growAndEmplaceBack(std::forward<Args>(args)...);
+        ::new (static_cast<void*>(m_data + m_size)) T(std::forward<Args>(args)...);
+        return m_data[m_size++];
+    }
+
+    void push_back(const T& item) { emplace_back(item); }
+    void push_back(T&& item) { emplace_back(std::move(item)); }
+
+    void pop_back()
+    {
+        m_data[--m_size].~T();
+    }
+
+    void resize(size_type count, const T& value = T())
+    {
+        if (count < m_size) {
+            std::destroy(m_data + count, m_data + m_size);
+            m_size = count;
+        }
+        else if (count > m_capacity) {
+            // Copied first: value may be an item of the vector, destroyed by the growth
+            const T item(value);
+            reserve(count);
+            std::uninitialized_fill(m_data + m_size, m_data + count, item);
+            m_size = count;
+        }
+        else {
+            std::uninitialized_fill(m_data + m_size, m_data + count, value);
+            m_size = count;
+        }
+    }
+
+    void assign(size_type count, const T& value)
+    {
+        // Copied first: value may be an item of the vector, destroyed by clear()
+        const T item(value);
+        clear();
+        resize(count, item);
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator position, Args&&... args)
+    {
+        const auto index { static_cast<size_type>(position - m_data) };
+        // Item built first: args may refer to an item of the vector
+        T item(std::forward<Args>(args)...);
+        if (index == m_size) {
+            emplace_back(std::move(item));
+            return m_data + index;
+        }
+        emplace_back(std::move(back()));
+        std::move_backward(m_data + index, m_data + m_size - 2, m_data + m_size - 1);
+        m_data[index] = std::move(item);
+        return m_data + index;
+    }
+
+    iterator insert(const_iterator position, const T& item) { return emplace(position, item); }
+    iterator insert(const_iterator position, T&& item) { return emplace(position, std::move(item)); }
+
+    iterator insert(const_iterator position, size_type count, const T& value)
+    {
+        const auto index { static_cast<size_type>(position - m_data) };
+        if (count == 0)
+            return m_data + index;
+        // Copied first: value may be an item of the vector, moved by the growth or the shift
+        const T item(value);
+        if (m_size + count > m_capacity)
+            reallocate(std::max(m_size + count, m_capacity * 2));
+
+        // Tail shifted once by 'count', items past the old end are built in uninitialized memory
+        T* first { m_data + index };
+        T* last { m_data + m_size };
+        const size_type tail { m_size - index };
+        if (tail > count) {
+            std::uninitialized_move(last - count, last, last);
+            std::move_backward(first, last - count, last);
+            std::fill_n(first, count, item);
+        }
+        else {
+            std::uninitialized_fill_n(last, count - tail, item);
+            std::uninitialized_move(first, last, first + count);
+            std::fill(first, last, item);
+        }
+        m_size += count;
+        return first;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        auto* begin { m_data + (first - m_data) };
+        auto* end { m_data + (last - m_data) };
+        if (begin != end) {
+            auto* newEnd { std::move(end, m_data + m_size, begin) };
+            std::destroy(newEnd, m_data + m_size);
+            m_size = static_cast<size_type>(newEnd - m_data);
+        }
+        return begin;
+    }
+
+    void clear()
+    {
+        std::destroy(m_data, m_data + m_size);
+        m_size = 0;
+    }
+
+    bool operator==(const small_vector& other) const
+    {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(m_inline); }
+
+    /// Slow path of emplace_back, kept out of line so that the fast path stays small
+    template<typename... Args>
+    [[gnu::noinline]] T& growAndEmplaceBack(Args&&... args)
+    {
+        // Item built before moving to a larger buffer: args may refer to an item of the vector
+        T item(std::forward<Args>(args)...);
+        reallocate(m_capacity * 2);
+        ::new (static_cast<void*>(m_data + m_size)) T(std::move(item));
+        return m_data[m_size++];
+    }
+
+    /// Moves items to a heap buffer of given capacity
+    void reallocate(size_type capacity)
+    {
+        capacity = std::max<size_type>(capacity, 1);
+        T* buffer { std::allocator<T>().allocate(capacity) };
+        std::uninitialized_move(m_data, m_data + m_size, buffer);
+        std::destroy(m_data, m_data + m_size);
+        release();
+        m_data = buffer;
+        m_capacity = capacity;
+    }
+
+    /// Frees heap buffer, if any, and goes back to inline storage
+    void release()
+    {
+        if (!is_inline())
+            std::allocator<T>().deallocate(m_data, m_capacity);
+        m_data = inlineData();
+        m_capacity = N;
+    }
+
+    /// Takes items of 'other', this object being empty and inline. Heap buffer is stolen.
+    void moveFrom(small_vector& other)
+    {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.begin(), other.end(), m_data);
+            m_size = other.m_size;
+            other.clear();
+        }
+        else {
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inlineData();
+            other.m_size = 0;
+            other.m_capacity = N;
+        }
+    }
+
+    alignas(T) std::byte m_inline[N * sizeof(T)];
+    T* m_data { inlineData() };
+    size_type m_size { 0 };
+    size_type m_capacity { N };
+};
+
+
+// enable operator<<
+template<typename T, std::size_t N>
+struct is_type_container<small_vector<T, N>> {
+  static const bool value = true;
+};
+
+
+#endif // SMALLVECTOR_H
@@ -0,0 +1,136 @@
+#ifndef STRINGCONCAT_H
+#define STRINGCONCAT_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+/*************************************
+ * STRING CONCATENATION (EXPRESSION TEMPLATE)
+ * a + " - " + b creates a temporary string for a + " - ", then appends b to it: several
+ * allocations (each time the temporary grows) and the first pieces are copied again on
+ * each growth. Passing strings by value adds a copy per parameter.
+ *
+ * concat(a, " - ", b) doesn't build anything: it returns a small object (an 'expression')
+ * keeping a view on each piece. The string is only built when the expression is converted
+ * to std::string: total length is computed first, a single allocation is made, and each
+ * piece is copied once.
+ * - pieces may be std::string, std::string_view, string literals, char arrays or pointers,
+ *   and single chars
+ * - expression + piece and piece + expression give a longer expression (flat, no tree):
+ *   concat(a) + " - " + b + '!' is still built with a single allocation
+ * - appendTo(out) appends to an existing string (one reallocation at most)
+ *
+ * IMPORTANT
+ * The expression refers to its pieces: it must be converted before they are destroyed.
+ * Store the result in a std::string, not in 'auto' (auto keeps the expression).
+ * **********************************/
+
+
+namespace detail {
+
+/// Types that can be a piece of a concatenation
+template<typename T>
+concept StringPiece = std::is_same_v<T, char> || std::is_convertible_v<const T&, std::string_view>;
+
+/// Text is kept as a view, a single char by value
+template<StringPiece T>
+auto toPiece(const T& value)
+{
+    if constexpr (std::is_same_v<T, char>)
+        return value;
+    else
+        return std::string_view(value);
+}
+
+template<typename T>
+using PieceOf = decltype(toPiece(std::declval<const T&>()));
+
+inline std::size_t pieceSize(std::string_view text) { return text.size(); }
+inline std::size_t pieceSize(char) { return 1; }
+
+inline void appendPiece(std::string& out, std::string_view text) { out.append(text); }
+inline void appendPiece(std::string& out, char c) { out.push_back(c); }
+
+} // namespace detail
+
+
+/// Lazy concatenation of pieces (string_view or char)
+template<typename... Pieces>
+class StringConcat
+{
+public:
+    explicit StringConcat(Pieces... pieces) : m_pieces(pieces...) {}
+
+    /// Length of the concatenated string
+    std::size_t size() const
+    {
+        return std::apply([](auto... pieces) { return (std::size_t { 0 } + ... + detail::pieceSize(pieces)); }, m_pieces);
+    }
+
+    std::string& appendTo(std::string& out) const
+    {
+        out.reserve(out.size() + size());
+        std::apply([&out](auto... pieces) { (detail::appendPiece(out, pieces), ...); }, m_pieces);
+        return out;
+    }
+
+    std::string str() const
+    {
+        std::string out;
+        appendTo(out);
+        return out;
+    }
+
+    operator std::string() const { return str(); }
+
+    template<detail::StringPiece T>
+    friend auto operator+(const StringConcat& expression, const T& piece)
+    {
+        return std::apply([&piece](auto... pieces) {
+            return StringConcat<Pieces..., detail::PieceOf<T>>(pieces..., detail::toPiece(piece));
+        }, expression.m_pieces);
+    }
+
+    template<detail::StringPiece T>
+    friend auto operator+(const T& piece, const StringConcat& expression)
+    {
+        return std::apply([&piece](auto... pieces) {
+            return StringConcat<detail::PieceOf<T>, Pieces...>(detail::toPiece(piece), pieces...);
+        }, expression.m_pieces);
+    }
+
+    template<typename... Others>
+    friend auto operator+(const StringConcat& left, const StringConcat<Others...>& right)
+    {
+        return std::apply([](auto... pieces) { return StringConcat<Pieces..., Others...>(pieces...); },
+                          std::tuple_cat(left.m_pieces, right.pieces()));
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const StringConcat& expression)
+    {
+        std::apply([&out](auto... pieces) { (out << ... << pieces); }, expression.m_pieces);
+        return out;
+    }
+
+    const std::tuple<Pieces...>& pieces() const { return m_pieces; }
+
+private:
+    std::tuple<Pieces...> m_pieces;
+};
+
+
+/// Expression concatenating all pieces, built when converted to std::string
+template<detail::StringPiece... T>
+auto concat(const T&... pieces)
+{
+    return StringConcat<detail::PieceOf<T>...>(detail::toPiece(pieces)...);
+}
+
+
+#endif // STRINGCONCAT_H
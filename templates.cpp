@@ -2,6 +2,13 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <list>
+#include <numeric>
+
+#include "fixedVector.h"
+#include "policyVector.h"
+#include "rangeSum.h"
+#include "stringConcat.h"
 
 using namespace std;
 
@@ -13,9 +20,10 @@ qu'il s'agit d'un template: une fonction appelée avec le type T.
 On peut appeler cette fonction avec n'importe quel type. Les seules contraintes à respecter sont:
 - a et b doivent être de même type
 - l'opérateur + doit exister pour le type T
+Les paramètres sont passés par référence constante: pas de copie pour les types coûteux (string).
 */
 template <typename T>
-T sum(T a, T b)
+T sum(const T& a, const T& b)
 {
     return (a + b);
 }
@@ -26,13 +34,42 @@ T sum(T a, T b)
 /* La fonction template peut égaement être spécialisée.
 Ici la même fonction est redéfinie pour le type particulier 'string'.
 L'implémentation peut être différente.
+a + " - " + b créerait des chaînes temporaires (une allocation à chaque agrandissement).
+concat() (stringConcat.h) ne construit rien: c'est une 'expression template' qui garde une vue
+sur chaque morceau. La chaîne est construite lors de la conversion en string: longueur totale
+calculée d'abord, une seule allocation, chaque morceau copié une seule fois.
 */
 template <>
-string sum<string>(string a, string b)
+string sum<string>(const string& a, const string& b)
+{
+    return concat(a, " - ", b);
+}
+
+/* Nombre variable de paramètres (C++17) */
+/*---------------------------------------*/
+
+/* sum(a, b) n'additionne que 2 valeurs: pour en additionner plus, il faut enchaîner les appels.
+Avec un 'parameter pack' (Rest...), la fonction accepte un nombre quelconque de paramètres.
+L'expression '(first + ... + rest)' est une 'fold expression': le compilateur la développe
+en ((first + rest1) + rest2) + ... sans récursivité.
+Avec exactement 2 paramètres de même type, c'est la version sum(const T& a, const T& b) ci-dessus qui est choisie
+(plus spécialisée).
+NOTE: le type du résultat est celui de l'addition: sum(1, 2.5, 3) est un double.
+*/
+template <typename T, typename... Rest>
+auto sum(T first, Rest... rest)
 {
-    return (a + " - " + b);
+    return (first + ... + rest);
 }
 
+/* La somme d'un conteneur (vector, list, array...) est dans rangeSum.h: sum(range).
+La stratégie est choisie à la compilation selon le type des éléments (if constexpr):
+- nombres en mémoire contiguë: instructions SIMD (plusieurs sommes partielles en parallèle)
+- chaînes: réservation de la taille totale, puis concaténation
+- sum(range, compensated): sommation compensée (Kahan/Neumaier) pour les flottants, l'erreur
+  d'arrondi ne grandit plus avec le nombre d'éléments
+*/
+
 /* TEMPLATE DE CLASSE */
 /*--------------------*/
 
@@ -149,6 +186,16 @@ private:
     array<T, size> m_values;
 };
 
+/* MyArrayClass devient un vecteur numérique dans fixedVector.h: FixedVector<T, N>.
+- même principe: taille connue à la compilation, tableau de taille fixe
+- stockage aligné et complété jusqu'à un nombre entier de registres SIMD
+- les opérateurs (+, -, *, fma, dot, norm) sont des 'expression templates': a * b + c ne
+  calcule rien, il construit un objet décrivant le calcul. Le calcul est fait en une seule
+  boucle lors de l'affectation à un FixedVector, sans vecteur temporaire.
+- 'if constexpr' choisit le code à la compilation: un vecteur qui tient dans un seul registre
+  est calculé sans boucle
+*/
+
 /* TEMPLATE TEMPLATE */
 /*-------------------*/
 
@@ -196,6 +243,16 @@ private:
     Policy<T> m_policy;
 };
 
+/* Un vrai conteneur construit sur ce principe est dans policyVector.h:
+policy_vector<T, Storage, Growth, Allocator, Bounds>. Chaque choix indépendant est une 'policy':
+- Storage (template template, comme Policy ci-dessus): tas, tampon interne, pages mmap
+- Growth: facteur 1.5, 2 ou taille exacte
+- Allocator: operator new, arène, 'huge pages'
+- Bounds: vérification des index par operator[] ou non
+La combinaison est choisie à la compilation: aucun coût à l'exécution (pas de fonction
+virtuelle, pas de test).
+*/
+
 /* VARIADIC TEMPLATE */
 /*-------------------*/
 
@@ -256,6 +313,25 @@ int main()
     cout << "- Call of specialized template function" << endl;
     cout << "  " << sum(string(" Hello "), string(" world ")) << endl;
 
+    // Expression template: string, string_view, littéraux et char mélangés, une seule allocation
+    const string name { "templates" };
+    const string_view greeting { "Hello" };
+    const string sentence = concat(greeting, ", ") + name + ' ' + "world" + '!';
+    cout << "- Lazy concatenation (expression template), " << sentence.size() << " chars, single allocation:" << endl;
+    cout << "  " << sentence << endl;
+
+    // Nombre variable de paramètres: fold expression
+    cout << "- Call of a variadic template function (fold expression):" << endl;
+    cout << "  1 + 2.5 + 3 + 4 = " << sum(1, 2.5, 3, 4) << endl;
+
+    // Somme d'un conteneur: stratégie choisie selon le type des éléments
+    cout << "- Sum of ranges, strategy chosen at compile time from the item type:" << endl;
+    const vector<float> tenths(10'000'000, 0.1f);
+    cout << "  10 million times 0.1f: loop=" << accumulate(tenths.begin(), tenths.end(), 0.0f)
+         << " SIMD=" << sum(tenths) << " compensated=" << sum(tenths, compensated) << endl;
+    const list<string> words { "Hello", " ", "templates", " ", "world" };
+    cout << "  strings: " << sum(words) << endl;
+
     /* TEMPLATE DE CLASSES */
     /*---------------------*/
 
@@ -316,6 +392,19 @@ int main()
     cout << "This code only exist in object 'array3', not in 'array2': ";
     array3.odd_or_even();
 
+    // Vecteur numérique: expression templates et SIMD
+    const FixedVector<double, 3> a(1., 2., 3.);
+    const FixedVector<double, 3> b(2.);
+    const FixedVector<double, 3> c(0.5, 0.5, 0.5);
+    const FixedVector<double, 3> r = a * b + c;
+    cout << endl
+         << "Expression templates" << endl;
+    cout << "--------------------" << endl;
+    cout << "- a * b + c in a single loop: " << a << " * " << b << " + " << c << " = " << r << endl;
+    cout << "- dot(a, b) = " << dot(a, b) << " ; norm(a - c) = " << norm(a - c) << endl;
+    cout << "- single SIMD register: " << boolalpha << FixedVector<double, 3>::singleRegister << " for 3 doubles, "
+         << FixedVector<float, 4>::singleRegister << " for 4 floats" << noboolalpha << endl;
+
     /* TEMPLATE TEMPLATE */
     /*-------------------*/
 
@@ -326,6 +415,22 @@ int main()
     MyTemplateTemplateClass<int, MyTemplateClass> template_template1(MyTemplateClass<int>(3));
     template_template1.run();
 
+    // Policy based design: stockage interne, croissance 1.5x, index vérifiés
+    policy_vector<int, InlineStorage, Growth1_5x, StdAllocator, BoundsChecked> policies;
+    for (int i = 0; i < 20; i++)
+    {
+        policies.push_back(i);
+    }
+    cout << "Policy based vector: " << policies.size() << " items, capacity " << policies.capacity() << endl;
+    try
+    {
+        policies[20] = 0;
+    }
+    catch (const out_of_range &e)
+    {
+        cout << "Checked operator[]: " << e.what() << endl;
+    }
+
     /* VARIADIC TEMPLATE */
     /*-------------------*/
 
@@ -0,0 +1,234 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "uniqueFunction.h"
+
+
+/*************************************
+ * WORK STEALING THREAD POOL
+ * Starting a std::thread per job costs a thread creation and destruction (tens of
+ * microseconds), and std::async with the default policy may either start a thread or
+ * defer the job until get() is called: behavior is up to the implementation.
+ *
+ * ThreadPool starts a fixed number of workers once, then runs jobs on them:
+ * - each worker has its own deque of jobs. A worker takes its jobs from the back
+ *   (latest job first: its data is still in cache), other workers steal from the front
+ *   (oldest jobs) when they have nothing left to do. Workers don't all fight for one queue.
+ * - jobs submitted from outside the pool are spread over workers in turn, jobs submitted
+ *   by a job go to the deque of its own worker
+ * - idle workers sleep on a condition variable, they are only woken up when jobs are pushed
+ *
+ * submit() returns a future, as std::async(std::launch::async, ...) does. post() runs a job
+ * without creating a future, for jobs whose result is not needed.
+ * parallelFor() splits an index range in chunks run by the pool. The calling thread
+ * runs jobs too while waiting, so parallelFor may be called from a job.
+ *
+ * IMPORTANT
+ * A job must not block on the future of another job (future.get()): all workers may end
+ * up waiting, with nobody left to run the jobs they wait for.
+ * **********************************/
+
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency())
+        : m_queues(std::max(1u, threadCount))
+    {
+        m_workers.reserve(m_queues.size());
+        for (std::size_t i { 0 }; i < m_queues.size(); i++)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Jobs already submitted are run before workers exit
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock { m_sleepMutex };
+            m_stop = true;
+        }
+        m_wakeUp.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    std::size_t size() const { return m_workers.size(); }
+
+    /// Runs f(args...) on a worker. Result, or exception thrown by f, is given through the future.
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+        std::packaged_task<Result()> task {
+            [f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable { return std::invoke(std::move(f), std::move(args)...); }
+        };
+        auto future { task.get_future() };
+        push(Job { std::move(task) });
+        return future;
+    }
+
+    /// Runs f() on a worker, without any future: f must not throw (exception would terminate the program)
+    template<typename F>
+    void post(F&& f)
+    {
+        push(Job { std::forward<F>(f) });
+    }
+
+    /// Runs f(i) for each i in [first, last), 'grain' indexes per job (0: 4 jobs per worker)
+    template<typename Index, typename F>
+    void parallelFor(Index first, Index last, F f, Index grain = 0)
+    {
+        if (!(first < last))
+            return;
+        const auto count { static_cast<std::size_t>(last - first) };
+        if (grain <= 0)
+            grain = static_cast<Index>(std::max<std::size_t>(1, count / (4 * size())));
+        const std::size_t chunks { (count + static_cast<std::size_t>(grain) - 1) / static_cast<std::size_t>(grain) };
+
+        std::atomic<std::size_t> remaining { chunks };
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        for (std::size_t chunk { 0 }; chunk < chunks; chunk++) {
+            const Index chunkFirst { static_cast<Index>(first + static_cast<Index>(chunk) * grain) };
+            const Index chunkLast { static_cast<Index>(std::min<std::size_t>(count, (chunk + 1) * static_cast<std::size_t>(grain))) + first };
+            push(Job { [&, chunkFirst, chunkLast] {
+                try {
+                    for (Index i { chunkFirst }; i < chunkLast; ++i)
+                        f(i);
+                } catch (...) {
+                    std::lock_guard lock { errorMutex };
+                    if (!error)
+                        error = std::current_exception();
+                }
+                remaining.fetch_sub(1, std::memory_order_release);
+            } });
+        }
+
+        // Help instead of sleeping: chunks may be queued behind this job if called from a worker
+        while (remaining.load(std::memory_order_acquire) > 0)
+            if (!runOneJob(currentWorker()))
+                std::this_thread::yield();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    /// Move only (std::function requires copyable callables, packaged_task isn't). Small jobs are not allocated.
+    using Job = unique_function<void(), 6 * sizeof(void*)>;
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    /// Index of the worker running the calling thread in this pool, size() for any other thread
+    std::size_t currentWorker() const
+    {
+        return t_pool == this ? t_worker : m_queues.size();
+    }
+
+    void push(Job job)
+    {
+        const std::size_t worker { currentWorker() };
+        auto& queue { m_queues[worker < m_queues.size() ? worker
+                                                        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size()] };
+        // Counted before being queued, so that the counter never goes below 0.
+        // Either the pushing thread sees a sleeping worker, or the worker sees the pending job.
+        m_pending.fetch_add(1);
+        {
+            std::lock_guard lock { queue.mutex };
+            queue.jobs.push_back(std::move(job));
+        }
+        if (m_sleeping.load() > 0) {
+            { std::lock_guard lock { m_sleepMutex }; }
+            m_wakeUp.notify_one();
+        }
+    }
+
+    /// Latest job of worker 'self', or oldest job of another worker. 'self' may be size() (not a worker).
+    Job takeJob(std::size_t self)
+    {
+        if (self < m_queues.size()) {
+            auto& queue { m_queues[self] };
+            std::lock_guard lock { queue.mutex };
+            if (!queue.jobs.empty()) {
+                Job job { std::move(queue.jobs.back()) };
+                queue.jobs.pop_back();
+                return job;
+            }
+        }
+        for (std::size_t i { 1 }; i <= m_queues.size(); i++) {
+            auto& queue { m_queues[(self + i) % m_queues.size()] };
+            std::unique_lock lock { queue.mutex, std::try_to_lock };
+            if (lock && !queue.jobs.empty()) {
+                Job job { std::move(queue.jobs.front()) };
+                queue.jobs.pop_front();
+                return job;
+            }
+        }
+        return {};
+    }
+
+    bool runOneJob(std::size_t self)
+    {
+        if (m_pending.load(std::memory_order_relaxed) == 0)
+            return false;
+        Job job { takeJob(self) };
+        if (!job)
+            return false;
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        job();
+        return true;
+    }
+
+    void workerLoop(std::size_t self)
+    {
+        t_pool = this;
+        t_worker = self;
+        while (true) {
+            if (runOneJob(self))
+                continue;
+            std::unique_lock lock { m_sleepMutex };
+            m_sleeping.fetch_add(1);
+            m_wakeUp.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+            m_sleeping.fetch_sub(1);
+            if (m_stop && m_pending.load() == 0)
+                return;
+        }
+    }
+
+    std::vector<WorkerQueue> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<std::size_t> m_nextQueue { 0 };
+    std::atomic<std::size_t> m_pending { 0 };   // jobs pushed and not yet taken
+    std::atomic<std::size_t> m_sleeping { 0 };
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeUp;
+    bool m_stop { false };
+
+    static inline thread_local const ThreadPool* t_pool { nullptr };
+    static inline thread_local std::size_t t_worker { 0 };
+};
+
+
+#endif // THREADPOOL_H
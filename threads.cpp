@@ -3,10 +3,22 @@
 #include <functional>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <semaphore>
 #include <sstream>
 #include <thread>
 #include <type_traits>
+#include <vector>
+
+#include "coroutineTask.h"
+#include "cpuTopology.h"
+#include "futureCombinators.h"
+#include "instrumentation.h"
+#include "lockFreeQueues.h"
+#include "sharedCounters.h"
+#include "threadPool.h"
+#include "timingWheel.h"
+#include "uniqueFunction.h"
 
 #define NOT_USED(expr) (void)(expr)
 
@@ -53,9 +65,11 @@ loopSleep(T delay, int count)
 }
 
 /// Will call a function on a variable (using reference)
+/// f is only called during this call: a function_ref (see uniqueFunction.h) avoids the copy and
+/// possible allocation of a std::function, and accepts any callable, move only ones included.
 template <typename T1, typename T2>
 typename enable_if<is_duration<T1>::value, void>::type
-applyFunctionOnVar(T1 delay, int count, function<void(T2&)> f, T2& a)
+applyFunctionOnVar(T1 delay, int count, function_ref<void(T2&)> f, T2& a)
 {
     while (count--) {
         f(a);
@@ -77,15 +91,19 @@ void postingFunc()
 
 /// This function waits for the synchro semaphore
 /// At each loop, it also checks the exit semaphore to detect if it has to stop.
+/// Wait durations are recorded in the "semaphore wait" histogram (see instrumentation.h).
 void waitingFunc()
 {
-    auto start { chrono::high_resolution_clock::now() };
+    auto& waitTime { instrumentation().histogram("semaphore wait") };
     while (!exitSemaphore.try_acquire()) {
-        auto duration { chrono::high_resolution_clock::now() - start };
-        cout << chrono::duration_cast<chrono::milliseconds>(duration).count() << "ms - Waiting" << endl;
-        synchroSemaphore.acquire();
-        duration = chrono::high_resolution_clock::now() - start;
-        cout << chrono::duration_cast<chrono::milliseconds>(duration).count() << "ms - Got it !" << endl;
+        cout << "Waiting" << endl;
+        chrono::nanoseconds waited;
+        {
+            ScopedTimer timer { waitTime };
+            synchroSemaphore.acquire();
+            waited = timer.elapsed();
+        }
+        cout << "Got it ! after " << chrono::duration_cast<chrono::milliseconds>(waited).count() << "ms" << endl;
     }
     cout << "Exiting waiting thread" << endl;
 }
@@ -123,6 +141,46 @@ void decr(int& a)
     cout << threadId() << ": decr: " << a << endl;
 }
 
+/// Coroutine version of fulfillPromises: sleeps without blocking a thread
+task<> fulfillAsyncPromises(CoroutineExecutor& executor, AsyncPromise<int> prom1, AsyncPromise<int> prom2, AsyncPromise<int> prom3)
+{
+    NOT_USED(prom3);
+
+    co_await executor.sleepFor(500ms);
+    cout << "Fulfill promises -> end of coroutine" << endl;
+    prom1.set_value(42);
+    prom2.set_exception(std::make_exception_ptr(std::runtime_error("Promise #2 failed")));
+}
+
+/// Awaits the 3 futures, as main does with std::future, but all together (when_all)
+task<> awaitFutures(CoroutineExecutor& executor)
+{
+    AsyncPromise<int> satisfiedPromise;
+    AsyncPromise<int> exceptionPromise;
+    AsyncPromise<int> brokenPromise;
+    auto satisfiedFuture { satisfiedPromise.get_future() };
+    auto exceptionFuture { exceptionPromise.get_future() };
+    auto brokenFuture { brokenPromise.get_future() };
+
+    executor.spawn(fulfillAsyncPromises(executor, move(satisfiedPromise), move(exceptionPromise), move(brokenPromise)));
+
+    // Total wait is the longest one, not the sum. Copies share the state: the futures below are then ready.
+    vector<AsyncFuture<int>> futures { satisfiedFuture, exceptionFuture, brokenFuture };
+    co_await when_all(move(futures));
+    cout << "All futures are ready, each one keeps its own result:" << endl;
+    cout << "- satisfied future -> value: " << co_await satisfiedFuture << endl;
+    try {
+        co_await exceptionFuture;
+    } catch (runtime_error& e) {
+        cout << "- exception future: " << e.what() << endl;
+    }
+    try {
+        co_await brokenFuture;
+    } catch (future_error& e) {
+        cout << "- broken promise: " << e.what() << endl;
+    }
+}
+
 // MAIN
 //======
 int main()
@@ -157,6 +215,22 @@ int main()
     thread_dec.join();
     cout << endl;
 
+    cout << "Same pattern with a thread safe counter (see sharedCounters.h): no update is lost." << endl;
+    cout << "ShardedCounter gives each thread its own part of the counter, parts are summed on read." << endl;
+    ShardedCounter<> counter;
+    auto incrCounter = [](ShardedCounter<>& c) { ++c; };
+    auto decrCounter = [](ShardedCounter<>& c) { c.add(-2); };
+    thread thread_incCounter { applyFunctionOnVar<chrono::milliseconds, ShardedCounter<>>, 10ms, 5, incrCounter, ref(counter) };
+    thread thread_decCounter { applyFunctionOnVar<chrono::milliseconds, ShardedCounter<>>, 10ms, 5, decrCounter, ref(counter) };
+    thread_incCounter.join();
+    thread_decCounter.join();
+    cout << "Counter value after 5 increments of 1 and 5 decrements of 2: " << counter.value() << endl;
+    // A move only callable can't be stored in a std::function, unique_function accepts it
+    unique_function<void(ShardedCounter<>&)> addBonus { [bonus = make_unique<long>(100)](ShardedCounter<>& c) { c.add(*bonus); } };
+    applyFunctionOnVar<chrono::milliseconds, ShardedCounter<>>(0ms, 1, addBonus, counter);
+    cout << "Counter value after a bonus of 100: " << counter.value() << endl;
+    cout << endl;
+
     cout << "Thread synchronisation" << endl;
     cout << "======================" << endl;
     cout << "One thread is constantly waiting for the semaphore to be released." << endl;
@@ -169,6 +243,23 @@ int main()
     thread_waiting.join();
     thread_posting.join();
 
+    cout << endl;
+    cout << "The semaphore only carries a signal, and a second semaphore is needed to stop." << endl;
+    cout << "A queue carries data: here the producer sends values through a lock free queue (see" << endl;
+    cout << "lockFreeQueues.h), a negative value tells the consumer to stop." << endl;
+    SpscQueue<int> values(16);
+    thread thread_consumer { [&values] {
+        for (int value { values.pop() }; value >= 0; value = values.pop())
+            cout << "Consumer got " << value << endl;
+        cout << "Exiting consumer thread" << endl;
+    } };
+    for (int value : { 1, 1, 2, 3, 5, 8 }) {
+        values.push(value);
+        this_thread::sleep_for(100ms);
+    }
+    values.push(-1);
+    thread_consumer.join();
+
     cout << endl;
     cout << "Promises" << endl;
     cout << "========" << endl;
@@ -190,7 +281,11 @@ int main()
 
     cout << "Thread started: waiting for futures:" << endl;
     {
-        auto val { satisfiedFuture.get() };
+        int val;
+        {
+            ScopedTimer timer { instrumentation().histogram("promise fulfilment") };
+            val = satisfiedFuture.get();
+        }
         cout << "Promise is fulfilled. Future is able to retrieve the value and unblocks" << endl;
         cout << "- satified future -> value: " << val << endl;
     }
@@ -223,10 +318,102 @@ int main()
          << endl;
 
     cout << "Start long computation asynchronously" << endl;
-    auto var { std::async(longComputation) };
+    // Default policy (launch::async | launch::deferred) lets the implementation choose between a new
+    // thread and running the function in get(). launch::async forces a new thread.
+    auto var { std::async(std::launch::async, longComputation) };
     cout << "Waiting for asynchronous computation to complete to retrieve result" << endl;
-    auto val { var.get() };
+    int val;
+    {
+        ScopedTimer timer { instrumentation().histogram("async completion") };
+        val = var.get();
+    }
     cout << "Asynchronous computation ended. Retrieved value: " << val << endl;
+    cout << endl;
+
+    cout << "Coroutines" << endl;
+    cout << "==========" << endl;
+    cout << "future.get blocks the thread while waiting. A coroutine suspends itself instead (co_await)" << endl;
+    cout << "and its thread runs something else meanwhile: many waits only need a few threads." << endl;
+    cout << "Same promises as above, awaited by a coroutine:" << endl
+         << endl;
+
+    {
+        CoroutineExecutor executor(1);
+        executor.syncWait(awaitFutures(executor));
+    }
+    cout << endl;
+
+    cout << "Timers" << endl;
+    cout << "======" << endl;
+    cout << "loopSleep and postingFunc keep a thread sleeping between runs, and each period adds the" << endl;
+    cout << "time of the work to the sleep. A timing wheel runs all timers from one thread, on schedule." << endl
+         << endl;
+    {
+        TimingWheel timers;
+        auto timerStart { chrono::steady_clock::now() };
+        int ticks { 0 };
+        auto periodic { timers.schedulePeriodic(100ms, 100ms, [&] {
+            auto duration { chrono::steady_clock::now() - timerStart };
+            cout << chrono::duration_cast<chrono::milliseconds>(duration).count() << "ms - Periodic timer #" << ++ticks << endl;
+        }) };
+        timers.schedule(550ms, [] { cout << "Single shot timer" << endl; });
+        this_thread::sleep_for(600ms);
+        timers.cancel(periodic);
+    }
+    cout << endl;
+
+    cout << "Thread pool" << endl;
+    cout << "===========" << endl;
+    cout << "Starting a thread for each job is costly. A pool starts its threads once, then runs" << endl;
+    cout << "the submitted jobs on them. submit returns a future, as async does." << endl
+         << endl;
+
+    ThreadPool pool;
+    cout << "Pool started with " << pool.size() << " threads" << endl;
+    auto poolVar { pool.submit(longComputation) };
+    auto poolSum { pool.submit([](int x, int y) { return x + y; }, 40, 2) };
+    cout << "Retrieved values: " << poolVar.get() << " and " << poolSum.get() << endl;
+
+    // parallelFor splits indexes in chunks that are run by the pool threads
+    vector<int> squares(20);
+    pool.parallelFor<size_t>(0, squares.size(), [&squares](size_t i) { squares[i] = static_cast<int>(i * i); });
+    cout << "Squares computed by the pool:";
+    for (auto square : squares)
+        cout << " " << square;
+    cout << endl;
+    cout << endl;
+
+    cout << "Thread placement" << endl;
+    cout << "================" << endl;
+    cout << "None of the threads above chose its CPU: the scheduler may move them from core to core." << endl;
+    cout << "Workers can be pinned to CPUs chosen from the machine topology (see cpuTopology.h)." << endl
+         << endl;
+    const auto topology { CpuTopology::detect() };
+    cout << topology.cpus().size() << " logical CPUs, " << topology.physicalCoreCount() << " physical cores, "
+         << topology.nodeCount() << " NUMA nodes" << endl;
+    const auto placement { topology.place(4, Placement::Scatter) };
+    vector<thread> pinnedThreads;
+    for (auto cpu : placement) {
+        pinnedThreads.emplace_back([cpu] {
+            const bool pinned { pinCurrentThread(cpu) };
+            // Allocated and initialized by the pinned thread: on its NUMA node
+            auto data { allocateLocal<int>(1024) };
+            NOT_USED(data);
+            cout << (threadId() + (pinned ? " pinned to CPU " : " not pinned, wanted CPU ") + to_string(cpu) + "\n");
+        });
+    }
+    for (auto& pinnedThread : pinnedThreads)
+        pinnedThread.join();
+    cout << endl;
+
+    cout << "Instrumentation" << endl;
+    cout << "===============" << endl;
+    cout << "Semaphore waits, promise fulfilment and async completion were timed by ScopedTimer into" << endl;
+    cout << "per thread histograms (see instrumentation.h), merged here:" << endl
+         << endl;
+    instrumentation().writeText(cout);
+    instrumentation().writeJson(cout);
+    cout << endl;
 
     return 0;
 }
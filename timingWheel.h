@@ -0,0 +1,285 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "threadPool.h"
+#include "uniqueFunction.h"
+
+
+/*************************************
+ * TIMING WHEEL
+ * Periodic work done with a loop around sleep_for pins a thread per job, and drifts:
+ * each period lasts 'sleep + work + wake up delay', errors accumulate.
+ * An ordered timer queue (map, heap) costs O(log n) per insertion and cancellation.
+ *
+ * A timing wheel is a circular array of slots, one per tick (1ms by default). A timer is
+ * put in the slot of its deadline; at each tick, the scheduler thread fires the timers
+ * of the current slot. Insertion and cancellation are O(1): each slot is a doubly linked
+ * list of timers, and a timer is identified by its index (plus a generation number, so
+ * that a stale TimerId doesn't cancel a newer timer reusing the same index).
+ *
+ * Hierarchical: 4 wheels of 256 slots. Wheel 0 has one slot per tick, wheel 1 one slot per
+ * 256 ticks, and so on (2^32 ticks in total, ~49 days with 1ms ticks). Far timers wait in
+ * an upper wheel, and are moved down ('cascaded') when the lower wheel comes round.
+ *
+ * - callbacks are run by a small ThreadPool, not by the scheduler thread: a slow callback
+ *   doesn't delay other timers
+ * - tick k is processed at start + k * tick (not 'previous tick + tick'), and a periodic
+ *   timer is re-armed at 'previous deadline + period': no drift, whatever the delays.
+ *   If the scheduler falls behind, it catches up by processing late ticks at once.
+ * - resolution is one tick: a timer fires at the first tick after its deadline. Processing
+ *   a tick takes some nanoseconds: ticks below a few microseconds keep the scheduler thread
+ *   busy catching up.
+ * - cancel() prevents future firings. A callback already handed to a worker still runs.
+ * **********************************/
+
+
+/// Identifies a timer to cancel it
+struct TimerId
+{
+    std::uint32_t index { 0 };
+    std::uint32_t generation { 0 };
+};
+
+
+class TimingWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = unique_function<void()>;   // move only callbacks are accepted
+
+    explicit TimingWheel(Clock::duration tick = std::chrono::milliseconds(1), unsigned workers = 2)
+        : m_tick(tick), m_start(Clock::now()), m_workers(workers)
+    {
+        m_heads.fill(none);
+        m_thread = std::thread(&TimingWheel::run, this);
+    }
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /// Timers not fired yet are dropped. Callbacks already handed to workers are completed.
+    ~TimingWheel()
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_stop = true;
+        }
+        m_stopChanged.notify_one();
+        m_thread.join();
+    }
+
+    /// Runs 'callback' once, after 'delay'
+    template<typename Rep, typename Period>
+    TimerId schedule(std::chrono::duration<Rep, Period> delay, Callback callback)
+    {
+        return add(Clock::now() + delay, Clock::duration::zero(), std::move(callback));
+    }
+
+    /// Runs 'callback' after 'delay', then every 'period'
+    template<typename Rep1, typename Period1, typename Rep2, typename Period2>
+    TimerId schedulePeriodic(std::chrono::duration<Rep1, Period1> delay, std::chrono::duration<Rep2, Period2> period,
+                             Callback callback)
+    {
+        return add(Clock::now() + delay, std::chrono::duration_cast<Clock::duration>(period), std::move(callback));
+    }
+
+    /// Returns false if the timer already fired (single shot) or was cancelled
+    bool cancel(TimerId id)
+    {
+        std::lock_guard lock { m_mutex };
+        if (id.index >= m_timers.size())
+            return false;
+        auto& timer { m_timers[id.index] };
+        if (!timer.active || timer.generation != id.generation)
+            return false;
+        unlink(id.index);
+        release(id.index);
+        return true;
+    }
+
+    std::size_t activeTimers() const
+    {
+        std::lock_guard lock { m_mutex };
+        return m_active;
+    }
+
+    Clock::duration tick() const { return m_tick; }
+
+private:
+    static constexpr unsigned slotBits { 8 };
+    static constexpr unsigned slotCount { 1 << slotBits };
+    static constexpr unsigned wheelCount { 4 };
+    static constexpr std::uint32_t none { UINT32_MAX };
+
+    struct Timer
+    {
+        std::uint64_t deadline { 0 };   // in ticks since start
+        std::uint64_t period { 0 };     // in ticks, 0 for single shot timers
+        std::shared_ptr<Callback> callback;   // shared with firings in progress (periodic timers)
+        std::uint32_t generation { 0 };
+        std::uint32_t slot { none };
+        std::uint32_t previous { none };
+        std::uint32_t next { none };    // next free timer when not active
+        bool active { false };
+    };
+
+    TimerId add(Clock::time_point deadline, Clock::duration period, Callback callback)
+    {
+        // Rounded up: never fires before its deadline
+        const auto ticks { (deadline - m_start + m_tick - Clock::duration(1)) / m_tick };
+        const auto periodTicks { (period + m_tick - Clock::duration(1)) / m_tick };
+
+        std::lock_guard lock { m_mutex };
+        std::uint32_t index;
+        if (m_free != none) {
+            index = m_free;
+            m_free = m_timers[index].next;
+        }
+        else {
+            index = static_cast<std::uint32_t>(m_timers.size());
+            m_timers.emplace_back();
+        }
+        auto& timer { m_timers[index] };
+        timer.deadline = static_cast<std::uint64_t>(std::max<std::int64_t>(ticks, 0));
+        timer.period = static_cast<std::uint64_t>(std::max<std::int64_t>(periodTicks, period > Clock::duration::zero() ? 1 : 0));
+        timer.callback = std::make_shared<Callback>(std::move(callback));
+        timer.active = true;
+        m_active++;
+        link(index);
+        return { index, timer.generation };
+    }
+
+    /// Puts the timer in the slot matching its deadline, in the lowest wheel that can hold it
+    void link(std::uint32_t index)
+    {
+        auto& timer { m_timers[index] };
+        // Late timers (deadline already processed) fire at next tick
+        const std::uint64_t deadline { std::max(timer.deadline, m_now) };
+        const std::uint64_t delta { deadline - m_now };
+        unsigned wheel { 0 };
+        while (wheel < wheelCount - 1 && delta >= (std::uint64_t { 1 } << (slotBits * (wheel + 1))))
+            wheel++;
+        std::uint64_t position { deadline >> (slotBits * wheel) };
+        // Beyond the range of the top wheel: parked in its last slot before a full turn, moved again then
+        if (delta >= (std::uint64_t { 1 } << (slotBits * wheelCount)))
+            position = (m_now >> (slotBits * wheel)) - 1;
+        const auto slot { static_cast<std::uint32_t>(wheel * slotCount + (position & (slotCount - 1))) };
+
+        timer.slot = slot;
+        timer.previous = none;
+        timer.next = m_heads[slot];
+        if (timer.next != none)
+            m_timers[timer.next].previous = index;
+        m_heads[slot] = index;
+    }
+
+    void unlink(std::uint32_t index)
+    {
+        auto& timer { m_timers[index] };
+        if (timer.previous != none)
+            m_timers[timer.previous].next = timer.next;
+        else
+            m_heads[timer.slot] = timer.next;
+        if (timer.next != none)
+            m_timers[timer.next].previous = timer.previous;
+    }
+
+    void release(std::uint32_t index)
+    {
+        auto& timer { m_timers[index] };
+        timer.active = false;
+        timer.generation++;
+        timer.callback.reset();
+        timer.next = m_free;
+        m_free = index;
+        m_active--;
+    }
+
+    /// Moves all timers of a slot of an upper wheel to lower wheels
+    void cascade(unsigned wheel)
+    {
+        const auto slot { static_cast<std::uint32_t>(wheel * slotCount + ((m_now >> (slotBits * wheel)) & (slotCount - 1))) };
+        std::uint32_t index { std::exchange(m_heads[slot], none) };
+        while (index != none) {
+            const std::uint32_t next { m_timers[index].next };
+            link(index);
+            index = next;
+        }
+    }
+
+    /// Fires timers of tick m_now, callbacks are gathered to be posted once the lock is released
+    void processTick(std::vector<std::shared_ptr<Callback>>& fired)
+    {
+        // Upper wheels come round: their current slot is moved down, from the top wheel to wheel 1
+        for (unsigned wheel { wheelCount - 1 }; wheel > 0; wheel--)
+            if ((m_now & ((std::uint64_t { 1 } << (slotBits * wheel)) - 1)) == 0)
+                cascade(wheel);
+
+        const auto slot { static_cast<std::uint32_t>(m_now & (slotCount - 1)) };
+        std::uint32_t index { std::exchange(m_heads[slot], none) };
+        while (index != none) {
+            auto& timer { m_timers[index] };
+            const std::uint32_t next { timer.next };
+            fired.push_back(timer.callback);
+            if (timer.period) {
+                // Next deadline from the previous one: no drift
+                timer.deadline += timer.period;
+                // A late timer must go to next tick, not back into the slot being processed
+                m_now++;
+                link(index);
+                m_now--;
+            }
+            else
+                release(index);
+            index = next;
+        }
+        m_now++;
+    }
+
+    void run()
+    {
+        std::vector<std::shared_ptr<Callback>> fired;
+        std::unique_lock lock { m_mutex };
+        while (!m_stop) {
+            const auto tickTime { m_start + m_tick * static_cast<Clock::rep>(m_now) };
+            if (Clock::now() < tickTime) {
+                m_stopChanged.wait_until(lock, tickTime);
+                continue;
+            }
+            processTick(fired);
+            if (fired.empty())
+                continue;
+            lock.unlock();
+            for (auto& callback : fired)
+                m_workers.post([callback = std::move(callback)] { (*callback)(); });
+            fired.clear();
+            lock.lock();
+        }
+    }
+
+    const Clock::duration m_tick;
+    const Clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stopChanged;
+    bool m_stop { false };
+    std::uint64_t m_now { 0 };      // next tick to process
+    std::vector<Timer> m_timers;
+    std::uint32_t m_free { none };  // free list of timers, linked through 'next'
+    std::size_t m_active { 0 };
+    std::array<std::uint32_t, wheelCount * slotCount> m_heads;
+    ThreadPool m_workers;
+    std::thread m_thread;
+};
+
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,221 @@
+#ifndef UNIQUEFUNCTION_H
+#define UNIQUEFUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+/*************************************
+ * TYPE ERASED CALLABLES
+ * std::function<void(int&)> holds any callable with this signature, but:
+ * - it must be copyable: a lambda capturing a unique_ptr (or a packaged_task) can't be stored
+ * - callables larger than its small internal buffer (16 bytes with libstdc++) are allocated
+ *   on the heap: a lambda capturing 3 references allocates
+ * - each call goes through a pointer: the compiler can't inline it
+ *
+ * unique_function<R(Args...), InlineSize>: owning, move only.
+ * - callables up to InlineSize bytes (3 pointers by default), that can be moved without
+ *   throwing, are stored inside the object: no allocation. Larger ones are allocated.
+ * - the type is erased with a table of 3 function pointers (call, move, destroy) per stored
+ *   type, built at compile time: no virtual functions, no RTTI.
+ * - calling an empty unique_function throws std::bad_function_call, as std::function.
+ *
+ * function_ref<R(Args...)>: non owning reference to a callable (an object pointer and a call
+ * function pointer). Never allocates, trivially copyable: fits parameters of functions that
+ * only call the callable before returning. The callable must outlive the function_ref: don't
+ * store a function_ref built from a temporary (a lambda written in the call is fine, it
+ * lives until the end of the call).
+ * **********************************/
+
+
+template<typename Signature, std::size_t InlineSize = 3 * sizeof(void*)>
+class unique_function;
+
+template<typename Signature>
+class function_ref;
+
+namespace detail {
+
+template<typename T>
+struct IsStdFunction : std::false_type {};
+
+template<typename Signature>
+struct IsStdFunction<std::function<Signature>> : std::true_type {};
+
+/// Function pointers, member pointers and std::function may be null: they give an empty unique_function
+template<typename F>
+bool isNullCallable(const F& f)
+{
+    if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F> || IsStdFunction<F>::value)
+        return !f;
+    else
+        return false;
+}
+
+/// std::invoke returning R (the result is dropped when R is void)
+template<typename R, typename F, typename... Args>
+R invokeAs(F&& f, Args&&... args)
+{
+    if constexpr (std::is_void_v<R>)
+        std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    else
+        return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+} // namespace detail
+
+
+template<typename R, typename... Args, std::size_t InlineSize>
+class unique_function<R(Args...), InlineSize>
+{
+public:
+    unique_function() noexcept = default;
+    unique_function(std::nullptr_t) noexcept {}
+
+    template<typename F, typename Stored = std::decay_t<F>>
+        requires(!std::is_same_v<Stored, unique_function> && std::is_invocable_r_v<R, Stored&, Args...>)
+    unique_function(F&& f)
+    {
+        if (detail::isNullCallable(f))
+            return;
+        if constexpr (storedInline<Stored>)
+            ::new (static_cast<void*>(m_storage)) Stored(std::forward<F>(f));
+        else
+            ::new (static_cast<void*>(m_storage)) Stored*(new Stored(std::forward<F>(f)));
+        m_operations = &operationsFor<Stored>;
+    }
+
+    unique_function(unique_function&& other) noexcept : m_operations(std::exchange(other.m_operations, nullptr))
+    {
+        if (m_operations)
+            m_operations->moveTo(other.m_storage, m_storage);
+    }
+
+    unique_function& operator=(unique_function&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_operations = std::exchange(other.m_operations, nullptr);
+            if (m_operations)
+                m_operations->moveTo(other.m_storage, m_storage);
+        }
+        return *this;
+    }
+
+    unique_function& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    unique_function(const unique_function&) = delete;
+    unique_function& operator=(const unique_function&) = delete;
+
+    ~unique_function() { reset(); }
+
+    explicit operator bool() const noexcept { return m_operations != nullptr; }
+
+    R operator()(Args... args)
+    {
+        if (!m_operations)
+            throw std::bad_function_call();
+        return m_operations->call(m_storage, std::forward<Args>(args)...);
+    }
+
+    /// True if callables of type F are stored without allocation
+    template<typename F>
+    static constexpr bool storedInline { sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t)
+                                         && std::is_nothrow_move_constructible_v<F> };
+
+private:
+    struct Operations
+    {
+        R (*call)(void* storage, Args&&... args);
+        void (*moveTo)(void* from, void* to) noexcept;   // moves the callable to empty storage 'to', 'from' becomes empty
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename F>
+    static F& target(void* storage)
+    {
+        if constexpr (storedInline<F>)
+            return *std::launder(static_cast<F*>(storage));
+        else
+            return **std::launder(static_cast<F**>(storage));
+    }
+
+    template<typename F>
+    static constexpr Operations operationsFor {
+        [](void* storage, Args&&... args) -> R { return detail::invokeAs<R>(target<F>(storage), std::forward<Args>(args)...); },
+        [](void* from, void* to) noexcept {
+            if constexpr (storedInline<F>) {
+                ::new (to) F(std::move(target<F>(from)));
+                target<F>(from).~F();
+            }
+            else
+                ::new (to) F*(*std::launder(static_cast<F**>(from)));
+        },
+        [](void* storage) noexcept {
+            if constexpr (storedInline<F>)
+                target<F>(storage).~F();
+            else
+                delete &target<F>(storage);
+        }
+    };
+
+    void reset() noexcept
+    {
+        if (m_operations)
+            std::exchange(m_operations, nullptr)->destroy(m_storage);
+    }
+
+    const Operations* m_operations { nullptr };
+    // Inline callable, or pointer to the allocated one
+    alignas(std::max_align_t) std::byte m_storage[InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize];
+};
+
+
+template<typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+public:
+    template<typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, function_ref> && std::is_invocable_r_v<R, F&, Args...>)
+    function_ref(F&& f) noexcept
+    {
+        using Callable = std::remove_reference_t<F>;
+        if constexpr (std::is_function_v<Callable> || std::is_pointer_v<Callable>) {
+            // Functions are referred to by their address, not by the address of a (temporary) pointer
+            using Pointer = std::conditional_t<std::is_pointer_v<Callable>, Callable, Callable*>;
+            m_target.function = reinterpret_cast<void (*)()>(static_cast<Pointer>(f));
+            m_call = [](Target target, Args&&... args) -> R {
+                return detail::invokeAs<R>(reinterpret_cast<Pointer>(target.function), std::forward<Args>(args)...);
+            };
+        }
+        else {
+            m_target.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+            m_call = [](Target target, Args&&... args) -> R {
+                return detail::invokeAs<R>(*static_cast<Callable*>(target.object), std::forward<Args>(args)...);
+            };
+        }
+    }
+
+    R operator()(Args... args) const { return m_call(m_target, std::forward<Args>(args)...); }
+
+private:
+    union Target
+    {
+        void* object;
+        void (*function)();
+    };
+
+    Target m_target;
+    R (*m_call)(Target target, Args&&... args);
+};
+
+
+#endif // UNIQUEFUNCTION_H